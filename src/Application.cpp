@@ -1,24 +1,177 @@
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cstdio>
-#include <fstream>
+#include <filesystem>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 #include <imgui.h>
 
 #include "Application.h"
 #include "ImGui/ImGuiWindow.h"
+#include "RGS/AssetCache.h"
 #include "RGS/Base.h"
 #include "RGS/Framebuffer.h"
 #include "RGS/InputCodes.h"
 #include "RGS/Texture.h"
+#include "RGS/TextureAtlas.h"
+#include "RGS/VirtualTexture.h"
 #include "RGS/Window.h"
 #include "RGS/Maths.h"
 #include "RGS/Shaders/BlinnShader.h"
+#include "RGS/Shaders/DeferredShader.h"
 #include "RGS/Renderer.h"
 using namespace RGS;
 
+namespace {
+
+constexpr int SCENE_GRID_SIZE = 316;            // 地面上物体网格的边长, 共约 10 万个物体
+constexpr float SCENE_GRID_SPACING = 2.5f;      // 网格中相邻物体的间距
+constexpr int ANIMATED_OBJECT_COUNT = 16;       // 绕原点旋转的物体数目
+constexpr int POINT_LIGHT_COUNT = 48;           // 地面上方移动的有限范围点光源数目
+constexpr float POINT_LIGHT_RANGE = 5.0f;       // 点光源的影响半径
+
+float GetMaxScale(const Mat4& transform)
+{
+    float maxScale = 0.0f;
+    for (int j = 0; j < 3; j++)
+    {
+        Vec3 axis { transform.M[0][j], transform.M[1][j], transform.M[2][j] };
+        maxScale = std::max(maxScale, Dot(axis, axis));
+    }
+    return (float)std::sqrt(maxScale);
+}
+
+/**
+ * @brief 世界空间位置变换到物体的模型空间, 模型矩阵左上 3x3 的逆为法线矩阵的转置
+*/
+Vec3 ToModelSpace(const SceneObject& object, const Vec3& worldPos)
+{
+    Vec3 offset = worldPos - Vec3{ object.Transform.M[0][3], object.Transform.M[1][3], object.Transform.M[2][3] };
+    const float (&n)[4][4] = object.NormalTransform.M;
+    return { n[0][0] * offset.X + n[1][0] * offset.Y + n[2][0] * offset.Z,
+             n[0][1] * offset.X + n[1][1] * offset.Y + n[2][1] * offset.Z,
+             n[0][2] * offset.X + n[1][2] * offset.Y + n[2][2] * offset.Z };
+}
+
+bool UsesAtlas(const Material& material)
+{
+    return material.Atlas && material.AtlasEntry >= 0;
+}
+
+/**
+ * @brief 材质的纹理坐标变换(XY 偏移, ZW 缩放), 图集材质映射到条目区域, 其余为整张纹理
+*/
+Vec4 GetTexCoordRegion(const Material& material)
+{
+    if (!UsesAtlas(material))
+        return { 0.0f, 0.0f, 1.0f, 1.0f };
+    const AtlasRegion& region = material.Atlas->GetRegion(material.AtlasEntry);
+    return { region.Offset.X, region.Offset.Y, region.Scale.X, region.Scale.Y };
+}
+
+/**
+ * @brief 两个材质是否使用同一图集页, 是则绑定的纹理相同, 物体可以合并为同一个实例批次
+*/
+bool ShareAtlasPage(const Material& a, const Material& b)
+{
+    return UsesAtlas(a) && UsesAtlas(b) && a.Atlas == b.Atlas
+        && a.Atlas->GetRegion(a.AtlasEntry).Page == b.Atlas->GetRegion(b.AtlasEntry).Page;
+}
+
+/**
+ * @brief 设置材质的纹理, 图集材质绑定条目所在图集页的各层
+ * @param interleaved 是否使用交错材质纹理, 图集没有交错材质纹理, BlinnMaterialFragmentShader 会退回分别采样
+*/
+void BindTextures(BlinnUniforms& uniforms, const Material& material, const bool interleaved)
+{
+    uniforms.VirtualDiffuse = material.VirtualDiffuse;
+    if (UsesAtlas(material))
+    {
+        const int page = material.Atlas->GetRegion(material.AtlasEntry).Page;
+        uniforms.Diffuse = material.Atlas->GetTexture(page, 0);
+        uniforms.Specular = material.Atlas->GetTexture(page, 1);
+        uniforms.Material = nullptr;
+        return;
+    }
+    uniforms.Diffuse = material.Diffuse.GetOrPlaceholder();
+    uniforms.Specular = material.Specular.GetOrPlaceholder();
+    uniforms.Material = interleaved ? material.Interleaved.GetOrPlaceholder() : nullptr;
+}
+
+// 一个实例批次的绘制参数, Cullings 非空时逐实例整簇剔除
+struct InstancedDraw
+{
+    const InstanceBuffer& Instances;
+    const MeshletCulling* Cullings;
+};
+
+/* 绘制网格的一个细节层级, culling 非空且网格有网格簇时在顶点着色前整簇剔除; 传入实例批次时按实例绘制 */
+
+void DrawLod(Framebuffer& framebuffer, const Program<BlinnVertex, BlinnUniforms, BlinnVaryings>& program,
+            const Mesh& mesh, const MeshLod& lod, const MeshletCulling* culling, const BlinnUniforms& uniforms)
+{
+    if (culling && lod.MeshletCount > 0)
+        Renderer::Draw(framebuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices(),
+                        mesh.GetMeshlets() + lod.MeshletOffset, lod.MeshletCount, *culling, uniforms);
+    else
+        Renderer::Draw(framebuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices() + lod.IndexOffset, lod.IndexCount, uniforms);
+}
+
+void DrawLod(Framebuffer& framebuffer, const Program<BlinnVertex, BlinnUniforms, BlinnVaryings>& program,
+            const Mesh& mesh, const MeshLod& lod, const InstancedDraw& batch, const BlinnUniforms& uniforms)
+{
+    if (batch.Cullings && lod.MeshletCount > 0)
+        Renderer::DrawInstanced(framebuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices(),
+                        mesh.GetMeshlets() + lod.MeshletOffset, lod.MeshletCount, batch.Instances, batch.Cullings, uniforms);
+    else
+        Renderer::DrawInstanced(framebuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices() + lod.IndexOffset, lod.IndexCount, batch.Instances, uniforms);
+}
+
+void DrawLodGeometry(GBuffer& gbuffer, const GeometryProgram<BlinnVertex, BlinnUniforms, BlinnVaryings>& program,
+            const Mesh& mesh, const MeshLod& lod, const MeshletCulling* culling, const BlinnUniforms& uniforms)
+{
+    if (culling && lod.MeshletCount > 0)
+        Renderer::DrawGeometry(gbuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices(),
+                        mesh.GetMeshlets() + lod.MeshletOffset, lod.MeshletCount, *culling, uniforms);
+    else
+        Renderer::DrawGeometry(gbuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices() + lod.IndexOffset, lod.IndexCount, uniforms);
+}
+
+void DrawLodGeometry(GBuffer& gbuffer, const GeometryProgram<BlinnVertex, BlinnUniforms, BlinnVaryings>& program,
+            const Mesh& mesh, const MeshLod& lod, const InstancedDraw& batch, const BlinnUniforms& uniforms)
+{
+    if (batch.Cullings && lod.MeshletCount > 0)
+        Renderer::DrawGeometryInstanced(gbuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices(),
+                        mesh.GetMeshlets() + lod.MeshletOffset, lod.MeshletCount, batch.Instances, batch.Cullings, uniforms);
+    else
+        Renderer::DrawGeometryInstanced(gbuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices() + lod.IndexOffset, lod.IndexCount, batch.Instances, uniforms);
+}
+
+void DrawLodDepth(Framebuffer& framebuffer, const DepthProgram& program,
+            const Mesh& mesh, const MeshLod& lod, const MeshletCulling* culling, const Mat4& mvp)
+{
+    if (culling && lod.MeshletCount > 0)
+        Renderer::DrawDepth(framebuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices(),
+                        mesh.GetMeshlets() + lod.MeshletOffset, lod.MeshletCount, *culling, mvp);
+    else
+        Renderer::DrawDepth(framebuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices() + lod.IndexOffset, lod.IndexCount, mvp);
+}
+
+void DrawLodDepth(Framebuffer& framebuffer, const DepthProgram& program,
+            const Mesh& mesh, const MeshLod& lod, const InstancedDraw& batch, const Mat4& viewProj)
+{
+    if (batch.Cullings && lod.MeshletCount > 0)
+        Renderer::DrawDepthInstanced(framebuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices(),
+                        mesh.GetMeshlets() + lod.MeshletOffset, lod.MeshletCount, batch.Instances, batch.Cullings, viewProj);
+    else
+        Renderer::DrawDepthInstanced(framebuffer, program, mesh.GetVertices(), lod.VertexCount, mesh.GetIndices() + lod.IndexOffset, lod.IndexCount, batch.Instances, viewProj);
+}
+
+}
+
 Application::Application(const std::string name, const int width, const int height)
     : m_Name(name),
     m_Width(width),
@@ -42,16 +195,121 @@ void Application::Init()
 
     m_LastFrameTime = std::chrono::steady_clock::now();
 
-    LoadMesh("assets/box.obj");
+    AssetCache& assetCache = AssetCache::Instance();
+    MeshOptions meshOptions;
+    meshOptions.Optimize = true;        // 优化结果与细节层级随 .rgsmesh 缓存保存, 只在首次加载时执行
+    meshOptions.GenerateLods = true;
+    meshOptions.BuildMeshlets = true;
+    m_Mesh = assetCache.GetMesh("assets/box.obj", meshOptions);
+    m_SphereMesh = assetCache.GetMesh("assets/sphere.obj", meshOptions);
+    // 纹理在后台线程池中异步解码, 加载完成前使用占位纹理
+    m_DiffuseTexture = assetCache.GetTextureAsync("assets/container2.png");
+    m_SpecularTexture = assetCache.GetTextureAsync("assets/container2_specular.png");
+    m_MaterialTexture = assetCache.GetMaterialTextureAsync("assets/container2.png", "assets/container2_specular.png");
+    // 虚拟纹理: 首次运行时由图片生成 .rgsvt, 之后只按需加载被采样到的页
+    const std::string virtualTexturePath = std::string("assets/container2") + VirtualTexture::EXTENSION;
+    std::error_code error;
+    if (std::filesystem::exists(virtualTexturePath, error) || VirtualTexture::Build("assets/container2.png", virtualTexturePath))
+        m_VirtualTexture = std::make_unique<VirtualTexture>(virtualTexturePath);
+
+    InitScene();
+}
+
+void Application::InitScene()
+{
+    Material crate;
+    crate.Diffuse = m_DiffuseTexture;
+    crate.Specular = m_SpecularTexture;
+    crate.Interleaved = m_MaterialTexture;
+    const uint32_t crateMaterial = m_Scene.AddMaterial(crate);
+    Material tinted = crate;
+    tinted.Color = { 0.6f, 0.8f, 1.0f };
+    tinted.VirtualDiffuse = m_VirtualTexture.get();
+    const uint32_t tintedMaterial = m_Scene.AddMaterial(tinted);
+
+    // 地面物体使用图集材质: 各条目位于同一图集页, 不同材质的物体仍可合并为同一个实例批次
+    Material crateAtlas;
+    crateAtlas.Atlas = &m_TextureAtlas;
+    crateAtlas.AtlasEntry = m_TextureAtlas.Add({ "assets/container2.png", "assets/container2_specular.png" });
+    Material steelAtlas = crateAtlas;
+    steelAtlas.AtlasEntry = m_TextureAtlas.Add({ "assets/container2_specular.png", "assets/container2_specular.png" });
+    steelAtlas.Color = { 0.6f, 0.8f, 1.0f };
+    m_TextureAtlas.Build();
+    const uint32_t crateAtlasMaterial = m_Scene.AddMaterial(crateAtlas);
+    const uint32_t steelAtlasMaterial = m_Scene.AddMaterial(steelAtlas);
+
+    // 一个照亮整个场景的主光源, 以及地面上方的有限范围彩色点光源, 每个屏幕块只受少数点光源影响
+    const Vec3 lightColors[] = { { 1.0f, 0.3f, 0.2f }, { 0.2f, 1.0f, 0.3f }, { 0.3f, 0.4f, 1.0f },
+                                 { 1.0f, 0.9f, 0.3f }, { 0.9f, 0.3f, 1.0f }, { 0.3f, 1.0f, 1.0f } };
+    m_Uniforms.Lights.assign(1, Light());
+    for (int i = 0; i < POINT_LIGHT_COUNT; i++)
+    {
+        Light light;
+        light.Range = POINT_LIGHT_RANGE;
+        light.Diffuse = lightColors[i % IM_ARRAYSIZE(lightColors)];
+        light.Specular = light.Diffuse;
+        m_Uniforms.Lights.push_back(light);
+    }
+
+    // 原点处的箱子, 以及绕它旋转的一圈球体
+    m_Scene.AddObject(m_Mesh, crateMaterial, Mat4Identity());
+    for (int i = 0; i < ANIMATED_OBJECT_COUNT; i++)
+        m_AnimatedObjects.push_back(m_Scene.AddObject(m_SphereMesh, tintedMaterial, Mat4Identity()));
+    UpdateScene(0.0f);
+
+    // 地面上的箱子与球体网格, 远平面之内只有几千个可见, 球体随距离切换细节层级
+    const float halfSize = (SCENE_GRID_SIZE - 1) * SCENE_GRID_SPACING * 0.5f;
+    for (int z = 0; z < SCENE_GRID_SIZE; z++)
+    {
+        for (int x = 0; x < SCENE_GRID_SIZE; x++)
+        {
+            const bool sphere = (x * 5 + z * 3) % 3 == 0;
+            const float scale = (0.6f + 0.4f * (float)((x * 7 + z * 13) % 5) / 4.0f) * (sphere ? 1.5f : 1.0f);
+            Mat4 transform = Mat4Translate(x * SCENE_GRID_SPACING - halfSize, -3.0f, z * SCENE_GRID_SPACING - halfSize)
+                * Mat4RotateY((float)((x * 31 + z * 17) % 16) * PI / 8.0f) * Mat4Scale(scale, scale, scale);
+            m_Scene.AddObject(sphere ? m_SphereMesh : m_Mesh, (x + z) % 2 ? crateAtlasMaterial : steelAtlasMaterial, transform);
+        }
+    }
+}
+
+void Application::UpdateScene(float time)
+{
+    m_Time += time;
+    for (int i = 0; i < (int)m_AnimatedObjects.size(); i++)
+    {
+        const float angle = m_Time * 0.5f + (float)i / m_AnimatedObjects.size() * 2.0f * PI;
+        Mat4 transform = Mat4Translate(4.0f * std::cos(angle), 0.5f * std::sin(m_Time + i), 4.0f * std::sin(angle))
+            * Mat4RotateY(-angle) * Mat4Scale(0.5f, 0.5f, 0.5f);
+        m_Scene.SetTransform(m_AnimatedObjects[i], transform);
+    }
 
-    m_Uniforms.Diffuse = new Texture("assets/container2.png");
-    m_Uniforms.Specular = new Texture("assets/container2_specular.png");
+    // 点光源分布在以原点为中心的几圈圆环上, 相邻圆环反向旋转
+    for (int i = 0; i < POINT_LIGHT_COUNT && i + 1 < (int)m_Uniforms.Lights.size(); i++)
+    {
+        const int ring = i % 4;
+        const float radius = 3.0f + ring * 5.0f;
+        const float angle = (ring % 2 ? -1.0f : 1.0f) * m_Time * 0.3f + (float)i / POINT_LIGHT_COUNT * 2.0f * PI * 4.0f;
+        m_Uniforms.Lights[i + 1].Pos = { radius * std::cos(angle), -1.5f, radius * std::sin(angle) - 6.0f };
+    }
 }
 
 void Application::Terminate()
 {   
-    delete m_Uniforms.Diffuse;
-    delete m_Uniforms.Specular;
+    m_Uniforms.Diffuse = nullptr;
+    m_Uniforms.Specular = nullptr;
+    m_Uniforms.Material = nullptr;
+    m_Uniforms.VirtualDiffuse = nullptr;
+    m_DiffuseTexture.Get();     // 等待尚未完成的加载任务
+    m_SpecularTexture.Get();
+    m_MaterialTexture.Get();
+    m_DiffuseTexture = TextureHandle();
+    m_SpecularTexture = TextureHandle();
+    m_MaterialTexture = TextureHandle();
+    m_Scene = Scene();
+    m_VirtualTexture.reset();
+    m_Mesh.reset();
+    m_SphereMesh.reset();
+    AssetCache::Instance().Clear();
 
     delete m_Window;
     Window::Terminate();
@@ -73,84 +331,6 @@ void Application::Run()
     }
 }
 
-void Application::LoadMesh(const char* filename)
-{
-    // TODO: 加载网格数据
-    std::ifstream file(filename);
-    ASSERT(file);
-
-    std::vector<Vec3> positions;        // 顶点信息
-    std::vector<Vec2> texCoords;;       // 纹理信息
-    std::vector<Vec3> normals;          // 法线信息
-    std::vector<int> posIndices;        // 顶点索引
-    std::vector<int> texIndices;        // 纹理索引
-    std::vector<int> normalIndices;     // 法线索引
-
-    std::string line;
-    while (!file.eof()) 
-    {
-        std::getline(file, line);
-        int items = -1;     // 记录每行有多少项
-        if (line.find("v ") == 0)                   /* Position */
-        {
-            Vec3 position;
-            items = std::sscanf(line.c_str(), "v %f %f %f", 
-                    &position.X, &position.Y, &position.Z);     // 读取三维坐标
-            ASSERT(items == 3);     // 确保读取成功(三个顶点)
-            positions.push_back(position);  // 加入顶点列表
-        }
-        else if (line.find("vt ") == 0)             /* Texcoord */
-        {
-            Vec2 texcoord;
-            items = std::sscanf(line.c_str(), "vt %f %f", 
-                    &texcoord.X, &texcoord.Y);     // 读取二维纹理坐标
-            ASSERT(items == 2);
-            texCoords.push_back(texcoord);
-        }
-        else if (line.find("vn ") == 0)             /* Normal */ 
-        {
-            Vec3 normal;
-            items = std::sscanf(line.c_str(), "vn %f %f %f", 
-                    &normal.X, &normal.Y, &normal.Z);     // 读取三维法线
-            ASSERT(items == 3);
-            normals.push_back(normal);
-        }
-        else if (line.find("f ") == 0)              /* Face */
-        {
-            int pIndices[3], uvIndices[3], nIndices[3];     
-            items = std::sscanf(line.c_str(), "f %d/%d/%d %d/%d/%d %d/%d/%d",
-                    &pIndices[0], &uvIndices[0], &nIndices[0],
-                    &pIndices[1], &uvIndices[1], &nIndices[1],
-                    &pIndices[2], &uvIndices[2], &nIndices[2]);
-            ASSERT(items == 9);
-            for (int i = 0; i < 3; i++)
-            {
-                posIndices.push_back(pIndices[i] - 1);      // 顶点索引从1开始
-                texIndices.push_back(uvIndices[i] - 1);     // 纹理索引从1开始
-                normalIndices.push_back(nIndices[i] - 1);   // 法线索引从1开始
-            }
-        }
-    }
-    file.close();       // 关闭文件
-
-    int triNum = posIndices.size() / 3;     // 三角形数量
-    for (int i = 0; i < triNum; i++)
-    {
-        Triangle<BlinnVertex> triangle;
-        for (int j = 0; j < 3; j++)
-        {
-            int index = 3 * i + j;
-            int posIndex = posIndices[index];
-            int texIndex = texIndices[index];
-            int nlIndex = normalIndices[index];
-            triangle[j].ModelPos = { positions[posIndex], 1.0f };
-            triangle[j].TexCoord = texCoords[texIndex];
-            triangle[j].ModelNormal = normals[nlIndex];
-        }
-        m_Mesh.emplace_back(triangle);
-    }
-}
-
 void Application::OnCameraUpdate(float time)
 {
     /* 移动 */
@@ -184,34 +364,257 @@ void Application::OnCameraUpdate(float time)
 void Application::OnUpdate(float time)
 {
     OnCameraUpdate(time);
+    UpdateScene(time);
 
     // imgui 界面
     m_ImGuiWindow->Begin();
     {
         ImGui::ShowDemoWindow(nullptr);
+
+        ImGui::Begin("RGS");
+        const char* renderPaths[] = { "Forward", "Deferred", "Forward+" };
+        int renderPath = (int)m_RenderPath;
+        if (ImGui::Combo("Render Path", &renderPath, renderPaths, IM_ARRAYSIZE(renderPaths)))
+            m_RenderPath = (RenderPath)renderPath;
+        ImGui::Checkbox("Z Pre-Pass", &m_EnableZPrepass);
+        ImGui::Checkbox("MSAA 4x (Forward)", &m_EnableMSAA);
+        if (ImGui::Checkbox("Dither", &m_EnableDither))
+            m_Window->SetDither(m_EnableDither);
+        const char* textureFilters[] = { "Nearest", "Bilinear", "Trilinear" };
+        int textureFilter = (int)m_Uniforms.TextureSampler.Filter;
+        if (ImGui::Combo("Texture Filter", &textureFilter, textureFilters, IM_ARRAYSIZE(textureFilters)))
+            m_Uniforms.TextureSampler.Filter = (TextureFilter)textureFilter;
+        const char* wrapModes[] = { "Repeat", "Mirror", "Clamp" };
+        int wrapMode = (int)m_Uniforms.TextureSampler.WrapU;
+        if (ImGui::Combo("Texture Wrap", &wrapMode, wrapModes, IM_ARRAYSIZE(wrapModes)))
+            m_Uniforms.TextureSampler.WrapU = m_Uniforms.TextureSampler.WrapV = (WrapMode)wrapMode;
+        ImGui::Checkbox("Interleaved Material", &m_EnableMaterialTexture);
+        ImGui::SliderFloat("LOD Error (px)", &m_LodErrorBudget, 0.1f, 16.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+        ImGui::Checkbox("Instancing", &m_EnableInstancing);
+        ImGui::Checkbox("Meshlet Culling", &m_EnableMeshletCulling);
+        ImGui::Checkbox("Occlusion Culling", &m_EnableOcclusionCulling);
+        ImGui::Text("Objects %zu / %zu visible, BVH height %d", m_DrawList.size(), m_Scene.GetObjectCount(), m_Scene.GetBvh().GetHeight());
+        ImGui::Text("%zu triangles", m_DrawnTriangleCount);
+        if (m_EnableInstancing)
+            ImGui::Text("%zu instanced draws", m_InstanceBatches.size());
+        if (m_VirtualTexture)
+            ImGui::Text("Virtual texture %d pages resident", m_VirtualTexture->GetResidentPageCount());
+        if (!m_DiffuseTexture.IsReady() || !m_SpecularTexture.IsReady() || !m_MaterialTexture.IsReady())
+            ImGui::Text("Loading textures...");
+        ImGui::End();
     }
     m_ImGuiWindow->End();
 
     Framebuffer framebuffer(m_Width, m_Height);
-    Program program(BlinnVertexShader, BlinnFragmentShader);
 
     Mat4 view = Mat4LookAt(m_Camera.Pos, m_Camera.Pos + m_Camera.Dir, {0.0f, 1.0f, 0.0f});
-    Mat4 proj = Mat4Perspective(90.0f / 360.0f * 2.0f * PI, m_Camera.Aspect, 0.1f, 100.0f);
+    const float fovy = 90.0f / 360.0f * 2.0f * PI;
+    Mat4 proj = Mat4Perspective(fovy, m_Camera.Aspect, 0.1f, 100.0f);
+
+    /* 视锥剔除后, 按世界包围盒到相机的距离与屏幕空间误差预算为每个物体选择细节层级 */
+    m_Scene.Cull(proj * view, m_VisibleObjects);
+    Vec3 cameraPos = m_Camera.Pos;
+    float projScale = (float)m_Height / (2.0f * std::tan(fovy * 0.5f));
+    m_DrawList.clear();
+    m_DrawnTriangleCount = 0;
+    for (ObjectId id : m_VisibleObjects)
+    {
+        const SceneObject& object = m_Scene.GetSceneObject(id);
+        Vec3 toCamera = cameraPos - object.WorldBounds.GetCenter();
+        Vec3 extent = object.WorldBounds.GetExtent();
+        float distance = (float)std::sqrt(Dot(toCamera, toCamera)) - (float)std::sqrt(Dot(extent, extent));
+        int lodIndex = object.ObjectMesh->SelectLod(distance, projScale, m_LodErrorBudget, GetMaxScale(object.Transform));
+        m_DrawList.push_back({ id, lodIndex });
+        m_DrawnTriangleCount += object.ObjectMesh->GetLods()[lodIndex].IndexCount / 3;
+    }
+    m_InstanceBatches.clear();
+    if (m_EnableInstancing)
+        BuildInstanceBatches();
 
-    Mat4 model = Mat4Identity();
-    m_Uniforms.MVP = proj * view * model;
     m_Uniforms.CameraPos = m_Camera.Pos;
-    m_Uniforms.Model = model;
-    m_Uniforms.ModelNormalToWorld = Mat4Identity();
 
     m_Uniforms.Shininess *= std::pow(2, time * 2.0f);
     if (m_Uniforms.Shininess > 256.0f)
         m_Uniforms.Shininess -= 256.0f;
 
-    for (auto tri : m_Mesh)
+    if (m_EnableMSAA && m_RenderPath == RenderPath::FORWARD)
     {
-        Renderer::Draw(framebuffer, program, tri, m_Uniforms);
+        /* 多重采样渲染后解析到单采样帧缓存 */
+        Framebuffer msaaFramebuffer(m_Width, m_Height, 4);
+        OnRender(msaaFramebuffer, view, proj);
+        msaaFramebuffer.Resolve(framebuffer);
     }
+    else
+    {
+        OnRender(framebuffer, view, proj);
+    }
+
+    m_PrevViewProj = proj * view;
+
+    // 根据本帧的采样反馈加载缺失的页并淘汰不再使用的页
+    if (m_VirtualTexture)
+        m_VirtualTexture->Update();
 
     m_Window->DrawFramebuffer(framebuffer);
-}
\ No newline at end of file
+}
+
+void Application::BuildInstanceBatches()
+{
+    for (const ObjectDraw& item : m_DrawList)
+    {
+        const SceneObject& object = m_Scene.GetSceneObject(item.Id);
+        const Mesh* mesh = object.ObjectMesh.get();
+        const Material& material = m_Scene.GetMaterial(object.MaterialIndex);
+        auto batch = std::find_if(m_InstanceBatches.begin(), m_InstanceBatches.end(), [&](const InstanceBatch& candidate)
+            {
+                return candidate.BatchMesh == mesh && candidate.LodIndex == item.LodIndex
+                    && (candidate.MaterialIndex == object.MaterialIndex || ShareAtlasPage(m_Scene.GetMaterial(candidate.MaterialIndex), material));
+            });
+        if (batch == m_InstanceBatches.end())
+        {
+            InstanceBatch newBatch;
+            newBatch.BatchMesh = mesh;
+            newBatch.MaterialIndex = object.MaterialIndex;
+            newBatch.LodIndex = item.LodIndex;
+            m_InstanceBatches.push_back(std::move(newBatch));
+            batch = m_InstanceBatches.end() - 1;
+        }
+        batch->Objects.push_back(item.Id);
+        batch->Instances.Add(object.Transform, object.NormalTransform, material.Color, GetTexCoordRegion(material));
+    }
+}
+
+MeshletCulling Application::GetMeshletCulling(const SceneObject& object, const Mat4& viewProj, const bool occlusion) const
+{
+    /* 网格簇剔除在模型空间进行; 运动物体的遮挡测试使用本帧的模型矩阵 */
+    MeshletCulling culling(viewProj * object.Transform, ToModelSpace(object, m_Uniforms.CameraPos));
+    if (occlusion)
+    {
+        culling.Occlusion = &m_DepthPyramid;
+        culling.OcclusionMVP = m_PrevViewProj * object.Transform;
+    }
+    return culling;
+}
+
+template<typename draw_func_t>
+void Application::ForEachVisibleObject(const Mat4& viewProj, const bool culling, const bool occlusion, draw_func_t&& draw)
+{
+    m_Uniforms.ViewProj = viewProj;
+    if (m_EnableInstancing)
+    {
+        for (InstanceBatch& batch : m_InstanceBatches)
+        {
+            // 模型矩阵来自实例缓冲, 只写深度的绘制也以 MVP 作为观察投影矩阵
+            const Material& material = m_Scene.GetMaterial(batch.MaterialIndex);
+            m_Uniforms.MVP = viewProj;
+            BindTextures(m_Uniforms, material, m_EnableMaterialTexture);
+
+            batch.Cullings.clear();
+            if (culling)
+            {
+                for (ObjectId id : batch.Objects)
+                    batch.Cullings.push_back(GetMeshletCulling(m_Scene.GetSceneObject(id), viewProj, occlusion));
+            }
+            draw(*batch.BatchMesh, batch.BatchMesh->GetLods()[batch.LodIndex], InstancedDraw{ batch.Instances, culling ? batch.Cullings.data() : nullptr });
+        }
+        return;
+    }
+
+    for (const ObjectDraw& item : m_DrawList)
+    {
+        const SceneObject& object = m_Scene.GetSceneObject(item.Id);
+        const Material& material = m_Scene.GetMaterial(object.MaterialIndex);
+        m_Uniforms.MVP = viewProj * object.Transform;
+        m_Uniforms.Model = object.Transform;
+        m_Uniforms.ModelNormalToWorld = object.NormalTransform;
+        m_Uniforms.ObjectColor = material.Color;
+        m_Uniforms.TexCoordRegion = GetTexCoordRegion(material);
+        BindTextures(m_Uniforms, material, m_EnableMaterialTexture);
+
+        MeshletCulling meshletCulling = GetMeshletCulling(object, viewProj, occlusion);
+        draw(*object.ObjectMesh, object.ObjectMesh->GetLods()[item.LodIndex], culling ? &meshletCulling : nullptr);
+    }
+}
+
+void Application::OnRender(Framebuffer& framebuffer, const Mat4& view, const Mat4& proj)
+{
+    const Mat4 viewProj = proj * view;
+    const bool useMeshlets = m_EnableMeshletCulling;
+    const bool useOcclusion = useMeshlets && m_EnableOcclusionCulling;
+    const bool hasPyramid = useOcclusion && m_DepthPyramid.GetWidth() == framebuffer.GetWidth() && m_DepthPyramid.GetHeight() == framebuffer.GetHeight();
+
+    if (m_RenderPath == RenderPath::FORWARD)
+    {
+        m_Uniforms.Grid = nullptr;
+        Program program(BlinnVertexShader, m_EnableMaterialTexture ? BlinnMaterialFragmentShader : BlinnFragmentShader);
+        program.InstancedVertexShader = BlinnInstancedVertexShader;
+        program.InstanceUniforms = BlinnInstanceUniforms;
+        if (m_EnableZPrepass && framebuffer.GetSampleCount() == 1)
+        {
+            /* Depth Pre-Pass (之后只着色最终可见的表面) */
+            DepthProgram depthProgram;
+            ForEachVisibleObject(viewProj, useMeshlets, hasPyramid, [&](const Mesh& mesh, const MeshLod& lod, const auto& source)
+                {
+                    DrawLodDepth(framebuffer, depthProgram, mesh, lod, source, m_Uniforms.MVP);
+                });
+            program.DepFunc = DepthFuncType::LEQUAL;  // 与 Forward+ 相同, 容忍两次光栅化深度插值的舍入差异
+            program.EnableWriteDepth = false;
+        }
+        ForEachVisibleObject(viewProj, useMeshlets, hasPyramid, [&](const Mesh& mesh, const MeshLod& lod, const auto& source)
+            {
+                DrawLod(framebuffer, program, mesh, lod, source, m_Uniforms);
+            });
+    }
+    else if (m_RenderPath == RenderPath::FORWARD_PLUS)
+    {
+        /* Depth Pre-Pass */
+        DepthProgram depthProgram;
+        ForEachVisibleObject(viewProj, useMeshlets, hasPyramid, [&](const Mesh& mesh, const MeshLod& lod, const auto& source)
+            {
+                DrawLodDepth(framebuffer, depthProgram, mesh, lod, source, m_Uniforms.MVP);
+            });
+
+        /* Light Culling */
+        m_LightGrid.Build(framebuffer, m_Uniforms.Lights, view, proj);
+        m_Uniforms.Grid = &m_LightGrid;
+
+        /* Shading Pass */
+        Program program(BlinnVertexShader, m_EnableMaterialTexture ? BlinnMaterialFragmentShader : BlinnFragmentShader);
+        program.InstancedVertexShader = BlinnInstancedVertexShader;
+        program.InstanceUniforms = BlinnInstanceUniforms;
+        program.DepFunc = DepthFuncType::LEQUAL;
+        program.EnableWriteDepth = false;
+        ForEachVisibleObject(viewProj, useMeshlets, hasPyramid, [&](const Mesh& mesh, const MeshLod& lod, const auto& source)
+            {
+                DrawLod(framebuffer, program, mesh, lod, source, m_Uniforms);
+            });
+    }
+    else if (m_RenderPath == RenderPath::DEFERRED)
+    {
+        /* Geometry Pass */
+        GBuffer gbuffer(framebuffer.GetWidth(), framebuffer.GetHeight());
+        GeometryProgram program(BlinnVertexShader, BlinnGeometryShader);
+        program.InstancedVertexShader = BlinnInstancedVertexShader;
+        program.InstanceUniforms = BlinnInstanceUniforms;
+        ForEachVisibleObject(viewProj, useMeshlets, hasPyramid, [&](const Mesh& mesh, const MeshLod& lod, const auto& source)
+            {
+                DrawLodGeometry(gbuffer, program, mesh, lod, source, m_Uniforms);
+            });
+        if (useOcclusion)
+            m_DepthPyramid.Build(gbuffer);
+
+        /* Lighting Pass */
+        m_DeferredUniforms.Lights = m_Uniforms.Lights;
+        m_DeferredUniforms.ViewProj = viewProj;
+        m_DeferredUniforms.CameraPos = m_Uniforms.CameraPos;
+        m_DeferredUniforms.LightAmbient = m_Uniforms.LightAmbient;
+        m_DeferredUniforms.Shininess = m_Uniforms.Shininess;
+        BlinnLightingPass(framebuffer, gbuffer, m_DeferredUniforms);
+    }
+
+    /* 保存本帧深度供下一帧遮挡剔除 */
+    if (!useOcclusion)
+        m_DepthPyramid.Reset();
+    else if (m_RenderPath != RenderPath::DEFERRED)
+        m_DepthPyramid.Build(framebuffer);
+}
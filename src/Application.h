@@ -1,12 +1,21 @@
 #pragma once
 
 #include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "RGS/AssetCache.h"
+#include "RGS/DepthPyramid.h"
+#include "RGS/LightGrid.h"
 #include "RGS/Maths.h"
+#include "RGS/Mesh.h"
 #include "RGS/Renderer.h"
+#include "RGS/Scene.h"
+#include "RGS/TextureAtlas.h"
+#include "RGS/VirtualTexture.h"
 #include "RGS/Shaders/BlinnShader.h"
+#include "RGS/Shaders/DeferredShader.h"
 #include "RGS/Window.h"
 #include "Imgui/ImGuiWindow.h"
 
@@ -22,6 +31,13 @@ struct Camera
     float Fovy = 45.0f;                                        // 视角
 };
 
+enum class RenderPath
+{
+    FORWARD,        // 前向渲染
+    DEFERRED,       // 延迟渲染
+    FORWARD_PLUS,   // 分块光源剔除的前向渲染
+};
+
 class Application
 {
 public:
@@ -36,8 +52,36 @@ private:
 
     void OnCameraUpdate(float time);    
     void OnUpdate(float time);
+    void OnRender(Framebuffer& framebuffer, const Mat4& view, const Mat4& proj);
+    void InitScene();   // 创建场景中的物体
+    void UpdateScene(float time);   // 移动动画物体
+    /**
+     * @brief 依次设置本帧可见物体的统一变量与网格簇剔除参数并调用 draw(mesh, lod, culling);
+     *        启用实例化时改为对每个实例批次设置共享的统一变量并调用 draw(mesh, lod, batch), 网格簇剔除参数逐实例计算
+     * @param culling 是否启用网格簇剔除, 否则传给 draw 的 culling 为空
+    */
+    template<typename draw_func_t>
+    void ForEachVisibleObject(const Mat4& viewProj, const bool culling, const bool occlusion, draw_func_t&& draw);
+    void BuildInstanceBatches();    // 将绘制列表中网格、细节层级与纹理相同的物体合并为实例批次, 颜色与图集区域逐实例设置
+    MeshletCulling GetMeshletCulling(const SceneObject& object, const Mat4& viewProj, const bool occlusion) const;     // 物体模型空间中的网格簇剔除参数
 
-    void LoadMesh(const char* filename);
+    // 本帧绘制的物体及其细节层级
+    struct ObjectDraw
+    {
+        ObjectId Id;
+        int LodIndex;
+    };
+
+    // 一次实例化绘制: 网格与细节层级相同、材质相同或位于同一图集页的可见物体
+    struct InstanceBatch
+    {
+        const Mesh* BatchMesh;
+        uint32_t MaterialIndex;                 // 批次中第一个物体的材质, 纹理由它绑定
+        int LodIndex;
+        InstanceBuffer Instances;
+        std::vector<ObjectId> Objects;          // 与实例一一对应的物体
+        std::vector<MeshletCulling> Cullings;   // 与实例一一对应的网格簇剔除参数, 每次绘制前计算
+    };
 
 private:
     std::string m_Name;
@@ -50,9 +94,36 @@ private:
 
     ImGuiWindow* m_ImGuiWindow;     // ImGui窗口
 
-    std::vector<Triangle<BlinnVertex>> m_Mesh;      // 网格
+    std::shared_ptr<Mesh> m_Mesh;                   // 箱子网格
+    std::shared_ptr<Mesh> m_SphereMesh;             // 球体网格, 三角形足够多, 会生成细节层级并划分为多个网格簇
+    Scene m_Scene;                                  // 场景
+    std::vector<ObjectId> m_AnimatedObjects;        // 每帧移动的物体
+    std::vector<ObjectId> m_VisibleObjects;         // 视锥剔除后的物体
+    std::vector<ObjectDraw> m_DrawList;             // 本帧绘制的物体
+    std::vector<InstanceBatch> m_InstanceBatches;   // 本帧的实例批次, 启用实例化时使用
+    size_t m_DrawnTriangleCount = 0;                // 本帧所选细节层级的三角形总数
+    float m_Time = 0.0f;                            // 动画时间
+    TextureHandle m_DiffuseTexture;                 // 漫反射纹理
+    TextureHandle m_SpecularTexture;                // 镜面反射纹理
+    TextureHandle m_MaterialTexture;                // 漫反射与镜面反射交错存储的材质纹理
+    TextureAtlas m_TextureAtlas { 2 };              // 地面物体材质的纹理图集, 每个条目两层(漫反射与镜面反射)
+    std::unique_ptr<VirtualTexture> m_VirtualTexture;   // 旋转球体的漫反射虚拟纹理, 每帧渲染后根据采样反馈更新页缓存
 
     BlinnUniforms m_Uniforms;       // 着色器参数
+
+    RenderPath m_RenderPath = RenderPath::FORWARD;      // 渲染路径
+    bool m_EnableZPrepass = false;                      // 前向渲染是否先进行深度预渲染
+    bool m_EnableMSAA = false;                          // 前向渲染是否启用 4x MSAA
+    bool m_EnableDither = false;                        // 显示时是否启用有序抖动
+    bool m_EnableMaterialTexture = true;                // 是否使用交错材质纹理(每像素一次采样)
+    float m_LodErrorBudget = 1.0f;                      // 细节层级选择允许的屏幕空间误差(像素)
+    bool m_EnableInstancing = true;                     // 是否将相同网格、材质与细节层级的物体合并为实例化绘制
+    bool m_EnableMeshletCulling = true;                 // 是否按网格簇做视锥与背面剔除
+    bool m_EnableOcclusionCulling = true;               // 是否用上一帧的深度金字塔剔除被遮挡的网格簇
+    DepthPyramid m_DepthPyramid;                        // 上一帧的深度金字塔
+    Mat4 m_PrevViewProj;                                // 上一帧的观察投影矩阵
+    DeferredLightingUniforms m_DeferredUniforms;        // 延迟光照参数
+    LightGrid m_LightGrid;                              // Forward+ 分块光源列表
 };
 
 }
\ No newline at end of file
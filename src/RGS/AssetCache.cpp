@@ -0,0 +1,222 @@
+#include "AssetCache.h"
+#include "Base.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+namespace RGS {
+
+AssetCache::AssetCache(const size_t memoryBudget)
+    : m_MemoryBudget(memoryBudget)
+{}
+
+bool TextureHandle::IsReady() const
+{
+    return m_Future.valid() && m_Future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+std::shared_ptr<Texture> TextureHandle::Get() const
+{
+    ASSERT(m_Future.valid());
+    ThreadPool::Background().Wait(m_Future);
+    return m_Future.get();
+}
+
+const Texture* TextureHandle::GetOrPlaceholder() const
+{
+    if (IsReady())
+        return m_Future.get().get();
+    return AssetCache::GetPlaceholderTexture();
+}
+
+std::shared_ptr<Texture> AssetCache::GetTexture(const std::string& path, const TextureOptions& options)
+{
+    return GetOrLoad<Texture>(GetTextureKey(path, options), [&]() { return std::make_shared<Texture>(path, options); });
+}
+
+TextureHandle AssetCache::GetTextureAsync(const std::string& path, const TextureOptions& options)
+{
+    return LoadTextureAsync(GetTextureKey(path, options), [path, options]() { return std::make_shared<Texture>(path, options); });
+}
+
+TextureHandle AssetCache::GetMaterialTextureAsync(const std::string& diffusePath, const std::string& specularPath, const TextureOptions& options)
+{
+    std::string key = "material:" + NormalizePath(diffusePath) + "|" + NormalizePath(specularPath) + GetOptionsKey(options);
+    return LoadTextureAsync(key, [diffusePath, specularPath, options]()
+        {
+            return std::shared_ptr<Texture>(LoadMaterialTexture(diffusePath, specularPath, options));
+        });
+}
+
+template<typename load_func_t>
+TextureHandle AssetCache::LoadTextureAsync(const std::string& key, load_func_t&& load)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Entries.find(key);
+    if (it != m_Entries.end())      // 已缓存, 返回已完成的句柄
+    {
+        it->second.LastUse = ++m_UseCounter;
+        std::promise<std::shared_ptr<Texture>> promise;
+        promise.set_value(std::static_pointer_cast<Texture>(it->second.Asset));
+        return TextureHandle(promise.get_future().share());
+    }
+    auto pending = m_PendingTextures.find(key);
+    if (pending != m_PendingTextures.end())
+        return pending->second;
+
+    // 解码与格式转换在后台线程池中执行, 完成后放入缓存
+    std::shared_future<std::shared_ptr<Texture>> future = ThreadPool::Background().Submit([this, key, load]()
+        {
+            std::shared_ptr<Texture> texture = load();
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_PendingTextures.erase(key);
+            return Insert(key, texture);
+        }).share();
+    // 任务完成时需要获取 m_Mutex 才能移出等待列表, 因此此处登记一定先于移出
+    TextureHandle handle(future);
+    m_PendingTextures[key] = handle;
+    return handle;
+}
+
+std::shared_ptr<Mesh> AssetCache::GetMesh(const std::string& path, const MeshOptions& options)
+{
+    std::string key = "mesh:" + NormalizePath(path) + "|optimize=" + std::to_string((int)options.Optimize)
+        + "|lods=" + std::to_string((int)options.GenerateLods) + "|meshlets=" + std::to_string((int)options.BuildMeshlets);
+    return GetOrLoad<Mesh>(key, [&]() { return std::make_shared<Mesh>(path, options); });
+}
+
+template<typename asset_t, typename load_func_t>
+std::shared_ptr<asset_t> AssetCache::GetOrLoad(const std::string& key, load_func_t&& load)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto it = m_Entries.find(key);
+        if (it != m_Entries.end())
+        {
+            it->second.LastUse = ++m_UseCounter;
+            return std::static_pointer_cast<asset_t>(it->second.Asset);
+        }
+    }
+
+    // 加载时不持有锁, 其他线程可以同时获取已缓存的资源
+    std::shared_ptr<asset_t> asset = load();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return Insert(key, std::move(asset));
+}
+
+template<typename asset_t>
+std::shared_ptr<asset_t> AssetCache::Insert(const std::string& key, std::shared_ptr<asset_t> asset)
+{
+    auto it = m_Entries.find(key);
+    if (it != m_Entries.end())      // 其他线程已加载同一资源, 使用先加载完成的那份
+    {
+        it->second.LastUse = ++m_UseCounter;
+        return std::static_pointer_cast<asset_t>(it->second.Asset);
+    }
+    size_t size = asset->GetMemorySize();
+    m_Entries[key] = { asset, size, ++m_UseCounter };
+    m_MemoryUsage += size;
+    if (m_MemoryUsage > m_MemoryBudget)
+        Evict(m_MemoryBudget);
+    return asset;
+}
+
+void AssetCache::SetMemoryBudget(const size_t memoryBudget)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MemoryBudget = memoryBudget;
+    if (m_MemoryUsage > m_MemoryBudget)
+        Evict(m_MemoryBudget);
+}
+
+size_t AssetCache::GetMemoryBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_MemoryBudget;
+}
+
+size_t AssetCache::GetMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_MemoryUsage;
+}
+
+size_t AssetCache::GetAssetCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Entries.size();
+}
+
+void AssetCache::Collect()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Evict(m_MemoryBudget);
+}
+
+void AssetCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Evict(0);
+}
+
+void AssetCache::Evict(const size_t targetUsage)
+{
+    // 按最近使用时间从旧到新淘汰, 仍被外部引用的资源不能淘汰
+    std::vector<std::unordered_map<std::string, Entry>::iterator> candidates;
+    for (auto it = m_Entries.begin(); it != m_Entries.end(); ++it)
+    {
+        if (it->second.Asset.use_count() == 1)
+            candidates.push_back(it);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+        [](const auto& a, const auto& b) { return a->second.LastUse < b->second.LastUse; });
+
+    for (auto& it : candidates)
+    {
+        if (m_MemoryUsage <= targetUsage)
+            break;
+        m_MemoryUsage -= it->second.Size;
+        m_Entries.erase(it);
+    }
+}
+
+std::string AssetCache::GetTextureKey(const std::string& path, const TextureOptions& options)
+{
+    return "texture:" + NormalizePath(path) + GetOptionsKey(options);
+}
+
+std::string AssetCache::GetOptionsKey(const TextureOptions& options)
+{
+    return "|mip=" + std::to_string((int)options.GenerateMipmaps)
+        + "|float=" + std::to_string((int)options.FloatStorage)
+        + "|layout=" + std::to_string((int)options.Layout)
+        + "|compress=" + std::to_string((int)options.Compress);
+}
+
+std::string AssetCache::NormalizePath(const std::string& path)
+{
+    std::error_code error;
+    std::filesystem::path absolutePath = std::filesystem::absolute(path, error);
+    if (error)
+        absolutePath = path;
+    return absolutePath.lexically_normal().generic_string();
+}
+
+AssetCache& AssetCache::Instance()
+{
+    static AssetCache cache;
+    return cache;
+}
+
+const Texture* AssetCache::GetPlaceholderTexture()
+{
+    static const uint8_t white[4] = { 255, 255, 255, 255 };
+    static const Texture placeholder(1, 1, TextureFormat::RGBA8, white);
+    return &placeholder;
+}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "RGS/Mesh.h"
+#include "RGS/Texture.h"
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace RGS {
+
+// 异步加载中的纹理句柄, 加载完成前可使用占位纹理渲染
+class TextureHandle
+{
+public:
+    TextureHandle() = default;
+    explicit TextureHandle(std::shared_future<std::shared_ptr<Texture>> future)
+        : m_Future(std::move(future)) {}
+
+    bool IsValid() const { return m_Future.valid(); }
+    bool IsReady() const;
+    std::shared_ptr<Texture> Get() const;           // 等待加载完成, 等待期间调用线程协助执行后台加载任务
+    const Texture* GetOrPlaceholder() const;        // 已加载完成时返回纹理, 否则返回占位纹理
+
+private:
+    std::shared_future<std::shared_ptr<Texture>> m_Future;
+};
+
+// 纹理与网格的共享缓存, 相同路径与加载参数只加载一次
+class AssetCache
+{
+public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 512ull * 1024 * 1024;
+
+    /**
+     * @param memoryBudget 内存预算(字节), 超出时淘汰最久未使用且无外部引用的资源
+    */
+    explicit AssetCache(const size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+
+    AssetCache(const AssetCache&) = delete;
+    AssetCache& operator=(const AssetCache&) = delete;
+
+    /**
+     * @brief 获取纹理, 缓存中不存在时加载
+     * @param path 纹理路径, 不同写法的同一路径(相对/绝对, ./ 与 ../)视为同一资源
+     * @param options 加载参数, 参数不同的同一纹理分别缓存
+    */
+    std::shared_ptr<Texture> GetTexture(const std::string& path, const TextureOptions& options = {});
+    /**
+     * @brief 在后台线程池中异步加载纹理(解码与格式转换), 立即返回句柄; 同一纹理正在加载时返回同一个句柄
+    */
+    TextureHandle GetTextureAsync(const std::string& path, const TextureOptions& options = {});
+    /**
+     * @brief 异步加载漫反射与镜面反射交错存储的材质纹理, 见 LoadMaterialTexture
+    */
+    TextureHandle GetMaterialTextureAsync(const std::string& diffusePath, const std::string& specularPath, const TextureOptions& options = {});
+    /**
+     * @brief 获取网格, 缓存中不存在时加载
+     * @param options 加载参数, 参数不同的同一网格分别缓存
+    */
+    std::shared_ptr<Mesh> GetMesh(const std::string& path, const MeshOptions& options = {});
+
+    void SetMemoryBudget(const size_t memoryBudget);
+    size_t GetMemoryBudget() const;
+    size_t GetMemoryUsage() const;      // 缓存中所有资源占用的字节数
+    size_t GetAssetCount() const;
+
+    void Collect();     // 淘汰无外部引用的资源, 直到不超过内存预算
+    void Clear();       // 释放所有无外部引用的资源
+
+    static AssetCache& Instance();
+    static const Texture* GetPlaceholderTexture();      // 1x1 白色纹理
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<void> Asset;    // 缓存持有一份引用, use_count 为 1 表示没有外部使用者
+        size_t Size;                    // 占用的字节数
+        uint64_t LastUse;               // 最近一次被获取的序号, 用于 LRU 淘汰
+    };
+
+    template<typename asset_t, typename load_func_t>
+    std::shared_ptr<asset_t> GetOrLoad(const std::string& key, load_func_t&& load);
+    template<typename load_func_t>
+    TextureHandle LoadTextureAsync(const std::string& key, load_func_t&& load);
+    template<typename asset_t>
+    std::shared_ptr<asset_t> Insert(const std::string& key, std::shared_ptr<asset_t> asset);    // 调用者需持有 m_Mutex
+    void Evict(const size_t targetUsage);   // 调用者需持有 m_Mutex
+
+    static std::string NormalizePath(const std::string& path);
+    static std::string GetTextureKey(const std::string& path, const TextureOptions& options);
+    static std::string GetOptionsKey(const TextureOptions& options);
+
+private:
+    std::unordered_map<std::string, Entry> m_Entries;
+    std::unordered_map<std::string, TextureHandle> m_PendingTextures;     // 正在异步加载的纹理
+    size_t m_MemoryBudget;
+    size_t m_MemoryUsage = 0;
+    uint64_t m_UseCounter = 0;
+    mutable std::mutex m_Mutex;
+};
+
+}
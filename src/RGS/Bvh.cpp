@@ -0,0 +1,234 @@
+#include "Bvh.h"
+
+#include <algorithm>
+
+namespace RGS {
+
+Bvh::Bvh(const float margin)
+    : m_Margin(margin)
+{
+    ASSERT(margin >= 0.0f);
+}
+
+int Bvh::Insert(const AABB& bounds, const uint32_t userData)
+{
+    const int leaf = AllocateNode();
+    Node& node = m_Nodes[leaf];
+    node.Bounds = Expand(bounds, m_Margin);
+    node.UserData = userData;
+    node.Height = 0;
+    InsertLeaf(leaf);
+    m_LeafCount++;
+    return leaf;
+}
+
+void Bvh::Remove(const int leaf)
+{
+    ASSERT(leaf >= 0 && leaf < (int)m_Nodes.size() && m_Nodes[leaf].IsLeaf() && m_Nodes[leaf].Height == 0);
+    RemoveLeaf(leaf);
+    FreeNode(leaf);
+    m_LeafCount--;
+}
+
+bool Bvh::Refit(const int leaf, const AABB& bounds)
+{
+    ASSERT(leaf >= 0 && leaf < (int)m_Nodes.size() && m_Nodes[leaf].IsLeaf() && m_Nodes[leaf].Height == 0);
+    Node& node = m_Nodes[leaf];
+    if (node.Bounds.Contains(bounds))
+    {
+        return false;
+    }
+
+    const AABB fatBounds = Expand(bounds, m_Margin);
+    if (!node.Bounds.Overlaps(fatBounds))
+    {
+        RemoveLeaf(leaf);
+        m_Nodes[leaf].Bounds = fatBounds;
+        InsertLeaf(leaf);
+        return true;
+    }
+    node.Bounds = fatBounds;
+    RefitAncestors(node.Parent, false);
+    return true;
+}
+
+void Bvh::Clear()
+{
+    m_Nodes.clear();
+    m_Root = INVALID_NODE;
+    m_FreeList = INVALID_NODE;
+    m_LeafCount = 0;
+}
+
+int Bvh::AllocateNode()
+{
+    if (m_FreeList == INVALID_NODE)
+    {
+        m_Nodes.emplace_back();
+        return (int)m_Nodes.size() - 1;
+    }
+    const int node = m_FreeList;
+    m_FreeList = m_Nodes[node].Parent;
+    m_Nodes[node] = Node();
+    return node;
+}
+
+void Bvh::FreeNode(const int node)
+{
+    m_Nodes[node].Parent = m_FreeList;
+    m_Nodes[node].Height = -1;
+    m_FreeList = node;
+}
+
+void Bvh::InsertLeaf(const int leaf)
+{
+    if (m_Root == INVALID_NODE)
+    {
+        m_Root = leaf;
+        m_Nodes[leaf].Parent = INVALID_NODE;
+        return;
+    }
+
+    /* 自上而下选择兄弟节点: 代价为新父节点的表面积加上祖先节点增大的表面积, 在子节点的代价都更高时停止 */
+    const AABB leafBounds = m_Nodes[leaf].Bounds;
+    int index = m_Root;
+    while (!m_Nodes[index].IsLeaf())
+    {
+        const Node& node = m_Nodes[index];
+        const float area = node.Bounds.GetSurfaceArea();
+        const float combinedArea = Union(node.Bounds, leafBounds).GetSurfaceArea();
+        const float cost = 2.0f * combinedArea;                     // 与该节点成为兄弟
+        const float inheritanceCost = 2.0f * (combinedArea - area); // 继续下降时该节点增大的表面积
+
+        float childCosts[2];
+        for (int i = 0; i < 2; i++)
+        {
+            const Node& child = m_Nodes[node.Children[i]];
+            const float childArea = Union(child.Bounds, leafBounds).GetSurfaceArea();
+            childCosts[i] = (child.IsLeaf() ? childArea : childArea - child.Bounds.GetSurfaceArea()) + inheritanceCost;
+        }
+        if (cost < childCosts[0] && cost < childCosts[1])
+        {
+            break;
+        }
+        index = childCosts[0] < childCosts[1] ? node.Children[0] : node.Children[1];
+    }
+
+    /* 新建父节点连接兄弟节点与叶节点 */
+    const int sibling = index;
+    const int oldParent = m_Nodes[sibling].Parent;
+    const int newParent = AllocateNode();
+    Node& parent = m_Nodes[newParent];
+    parent.Parent = oldParent;
+    parent.Bounds = Union(leafBounds, m_Nodes[sibling].Bounds);
+    parent.Height = m_Nodes[sibling].Height + 1;
+    parent.Children[0] = sibling;
+    parent.Children[1] = leaf;
+    if (oldParent != INVALID_NODE)
+    {
+        Node& grandParent = m_Nodes[oldParent];
+        grandParent.Children[grandParent.Children[0] == sibling ? 0 : 1] = newParent;
+    }
+    else
+    {
+        m_Root = newParent;
+    }
+    m_Nodes[sibling].Parent = newParent;
+    m_Nodes[leaf].Parent = newParent;
+
+    RefitAncestors(newParent, true);
+}
+
+void Bvh::RemoveLeaf(const int leaf)
+{
+    if (leaf == m_Root)
+    {
+        m_Root = INVALID_NODE;
+        return;
+    }
+
+    // 父节点由兄弟节点取代
+    const int parent = m_Nodes[leaf].Parent;
+    const int grandParent = m_Nodes[parent].Parent;
+    const int sibling = m_Nodes[parent].Children[m_Nodes[parent].Children[0] == leaf ? 1 : 0];
+    m_Nodes[sibling].Parent = grandParent;
+    FreeNode(parent);
+    if (grandParent == INVALID_NODE)
+    {
+        m_Root = sibling;
+        return;
+    }
+    Node& node = m_Nodes[grandParent];
+    node.Children[node.Children[0] == parent ? 0 : 1] = sibling;
+    RefitAncestors(grandParent, true);
+}
+
+void Bvh::RefitAncestors(int node, const bool balance)
+{
+    while (node != INVALID_NODE)
+    {
+        if (balance)
+        {
+            node = Balance(node);
+        }
+        Node& current = m_Nodes[node];
+        const Node& child0 = m_Nodes[current.Children[0]];
+        const Node& child1 = m_Nodes[current.Children[1]];
+        current.Bounds = Union(child0.Bounds, child1.Bounds);
+        current.Height = 1 + std::max(child0.Height, child1.Height);
+        node = current.Parent;
+    }
+}
+
+int Bvh::Balance(const int a)
+{
+    Node& nodeA = m_Nodes[a];
+    if (nodeA.IsLeaf() || nodeA.Height < 2)
+    {
+        return a;
+    }
+
+    /* 较高的子节点 C 旋转到 A 的位置, A 成为 C 的子节点, C 较高的孙节点留在 C 下, 较矮的交给 A */
+    const int balance = m_Nodes[nodeA.Children[1]].Height - m_Nodes[nodeA.Children[0]].Height;
+    if (balance >= -1 && balance <= 1)
+    {
+        return a;
+    }
+    const int high = balance > 1 ? 1 : 0;      // 较高子节点在 A 中的位置
+    const int c = nodeA.Children[high];
+    const int b = nodeA.Children[1 - high];
+    Node& nodeC = m_Nodes[c];
+    const int f = nodeC.Children[0];
+    const int g = nodeC.Children[1];
+    Node& nodeF = m_Nodes[f];
+    Node& nodeG = m_Nodes[g];
+
+    nodeC.Children[0] = a;
+    nodeC.Parent = nodeA.Parent;
+    nodeA.Parent = c;
+    if (nodeC.Parent != INVALID_NODE)
+    {
+        Node& parent = m_Nodes[nodeC.Parent];
+        parent.Children[parent.Children[0] == a ? 0 : 1] = c;
+    }
+    else
+    {
+        m_Root = c;
+    }
+
+    const bool keepF = nodeF.Height > nodeG.Height;
+    const int kept = keepF ? f : g;
+    const int moved = keepF ? g : f;
+    nodeC.Children[1] = kept;
+    nodeA.Children[high] = moved;
+    m_Nodes[moved].Parent = a;
+
+    const Node& nodeB = m_Nodes[b];
+    nodeA.Bounds = Union(nodeB.Bounds, m_Nodes[moved].Bounds);
+    nodeA.Height = 1 + std::max(nodeB.Height, m_Nodes[moved].Height);
+    nodeC.Bounds = Union(nodeA.Bounds, m_Nodes[kept].Bounds);
+    nodeC.Height = 1 + std::max(nodeA.Height, m_Nodes[kept].Height);
+    return c;
+}
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Base.h"
+#include "Frustum.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RGS {
+
+// 动态包围体层次(二叉 AABB 树): 增量插入与删除, 插入时按表面积代价选择兄弟节点, 并用旋转保持树的平衡
+// 叶节点保存扩大 margin 后的包围盒, 物体在其中小幅移动时无需更新树
+class Bvh
+{
+public:
+    static constexpr int INVALID_NODE = -1;
+
+    /**
+     * @param margin 叶节点包围盒向各方向扩大的距离
+    */
+    explicit Bvh(const float margin = 0.1f);
+
+    /**
+     * @brief 插入叶节点
+     * @param bounds 物体的包围盒
+     * @param userData 叶节点携带的数据, 查询时返回
+     * @return 叶节点编号, 在删除前保持不变
+    */
+    int Insert(const AABB& bounds, const uint32_t userData);
+    void Remove(const int leaf);
+    /**
+     * @brief 物体移动后更新叶节点: 仍在扩大的包围盒内时不做任何事; 否则更新叶节点并自下而上重新拟合祖先节点,
+     *        新旧包围盒不相交(大距离移动)时删除后重新插入, 以免祖先节点被拉得过大
+     * @return 树是否被修改
+    */
+    bool Refit(const int leaf, const AABB& bounds);
+    void Clear();
+
+    uint32_t GetUserData(const int leaf) const { return m_Nodes[leaf].UserData; }
+    const AABB& GetFatBounds(const int leaf) const { return m_Nodes[leaf].Bounds; }
+    size_t GetLeafCount() const { return m_LeafCount; }
+    int GetHeight() const { return m_Root == INVALID_NODE ? 0 : m_Nodes[m_Root].Height; }
+
+    /**
+     * @brief 视锥查询: 剔除完全在视锥外的子树, 完全在视锥内的子树不再测试, 直接访问其所有叶节点
+     * @param visit 对每个可能可见的叶节点调用 visit(userData, fullyInside),
+     *              fullyInside 为 false 时叶节点的扩大包围盒与视锥边界相交, 可再用物体的精确包围盒测试
+    */
+    template<typename visit_func_t>
+    void Query(const Frustum& frustum, visit_func_t&& visit) const
+    {
+        if (m_Root == INVALID_NODE)
+        {
+            return;
+        }
+
+        // 平衡树的高度不超过 1.44 log2(n), 深度优先遍历的栈深度不超过树高 + 1
+        struct StackEntry
+        {
+            int Node;
+            bool Inside;
+        };
+        StackEntry stack[MAX_QUERY_STACK];
+        int stackSize = 0;
+        stack[stackSize++] = { m_Root, false };
+        while (stackSize > 0)
+        {
+            const StackEntry entry = stack[--stackSize];
+            const Node& node = m_Nodes[entry.Node];
+            bool inside = entry.Inside;
+            if (!inside)
+            {
+                FrustumTestResult result = frustum.Test(node.Bounds);
+                if (result == FrustumTestResult::OUTSIDE)
+                {
+                    continue;
+                }
+                inside = result == FrustumTestResult::INSIDE;
+            }
+
+            if (node.IsLeaf())
+            {
+                visit(node.UserData, inside);
+                continue;
+            }
+            ASSERT(stackSize + 2 <= MAX_QUERY_STACK);
+            stack[stackSize++] = { node.Children[1], inside };
+            stack[stackSize++] = { node.Children[0], inside };
+        }
+    }
+
+private:
+    struct Node
+    {
+        AABB Bounds;
+        int Parent = INVALID_NODE;          // 空闲节点中为下一个空闲节点
+        int Children[2] = { INVALID_NODE, INVALID_NODE };
+        uint32_t UserData = 0;
+        int Height = 0;                     // 叶节点为 0, 空闲节点为 -1
+
+        bool IsLeaf() const { return Children[0] == INVALID_NODE; }
+    };
+
+    static constexpr int MAX_QUERY_STACK = 64;
+
+    int AllocateNode();
+    void FreeNode(const int node);
+    void InsertLeaf(const int leaf);
+    void RemoveLeaf(const int leaf);
+    void RefitAncestors(int node, const bool balance);     // 从 node 向上重新计算包围盒与高度, 可选地旋转不平衡的节点
+    int Balance(const int node);            // 左右子树高度相差超过 1 时旋转, 返回该位置新的子树根
+
+private:
+    float m_Margin;
+    std::vector<Node> m_Nodes;
+    int m_Root = INVALID_NODE;
+    int m_FreeList = INVALID_NODE;
+    size_t m_LeafCount = 0;
+};
+
+}
@@ -0,0 +1,100 @@
+#include "ColorConvert.h"
+
+#include "Base.h"
+#include "ThreadPool.h"
+
+#include <emmintrin.h>
+
+namespace RGS {
+
+// 4x4 Bayer 有序抖动矩阵, 已映射到 [-0.5, 0.5) 个量化单位
+static constexpr float s_BayerMatrix[4][4] = {
+    { -0.46875f,  0.03125f, -0.34375f,  0.15625f },
+    {  0.28125f, -0.21875f,  0.40625f, -0.09375f },
+    { -0.28125f,  0.21875f, -0.40625f,  0.09375f },
+    {  0.46875f, -0.03125f,  0.34375f, -0.15625f },
+};
+
+static inline uint8_t ConvertChannel(const float value, const float dither)
+{
+    float scaled = Clamp(value, 0.0f, 1.0f) * 255.0f + dither + 0.5f;
+    return (uint8_t)Clamp(scaled, 0.0f, 255.0f);
+}
+
+void ConvertRowToBGRA8(uint8_t* dst, const Vec3* src, const int count, const int ditherRow)
+{
+    const float* srcFloat = (const float*)src;
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    const __m128 dither = ditherRow >= 0 ? _mm_loadu_ps(s_BayerMatrix[ditherRow & 3]) : zero;
+    const __m128 bias = _mm_add_ps(half, dither);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        // 4 个像素: m0 = r0 g0 b0 r1, m1 = g1 b1 r2 g2, m2 = b2 r3 g3 b3
+        const float* p = srcFloat + i * 3;
+        __m128 m0 = _mm_loadu_ps(p);
+        __m128 m1 = _mm_loadu_ps(p + 4);
+        __m128 m2 = _mm_loadu_ps(p + 8);
+
+        // 转置为 RRRR GGGG BBBB
+        __m128 r = _mm_shuffle_ps(m0, _mm_shuffle_ps(m1, m2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        __m128 g = _mm_shuffle_ps(_mm_shuffle_ps(m0, m1, _MM_SHUFFLE(0, 0, 1, 1)),
+                                  _mm_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 b = _mm_shuffle_ps(_mm_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 1, 2, 2)),
+                                  _mm_shuffle_ps(m2, m2, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+        // 限制范围、缩放并加上抖动与 0.5 后截断取整
+        r = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(r, zero), one), scale), bias), zero), scale);
+        g = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(g, zero), one), scale), bias), zero), scale);
+        b = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(b, zero), one), scale), bias), zero), scale);
+        __m128i ri = _mm_cvttps_epi32(r);
+        __m128i gi = _mm_cvttps_epi32(g);
+        __m128i bi = _mm_cvttps_epi32(b);
+
+        // 打包为 0xAARRGGBB, 小端内存顺序即 B G R A
+        __m128i pixels = _mm_or_si128(_mm_or_si128(bi, _mm_slli_epi32(gi, 8)), _mm_or_si128(_mm_slli_epi32(ri, 16), alpha));
+        _mm_storeu_si128((__m128i*)(dst + i * 4), pixels);
+    }
+
+    for (; i < count; i++)
+    {
+        float d = ditherRow >= 0 ? s_BayerMatrix[ditherRow & 3][i & 3] : 0.0f;
+        dst[i * 4 + 0] = ConvertChannel(src[i].Z, d);
+        dst[i * 4 + 1] = ConvertChannel(src[i].Y, d);
+        dst[i * 4 + 2] = ConvertChannel(src[i].X, d);
+        dst[i * 4 + 3] = 255;
+    }
+}
+
+void ConvertFramebufferToBGRA8(uint8_t* dst,
+                                const int dstPitch,
+                                const Framebuffer& framebuffer,
+                                const int width,
+                                const int height,
+                                const bool dither)
+{
+    ASSERT(framebuffer.GetSampleCount() == 1, "多重采样帧缓存需要先 Resolve");
+    ASSERT(width <= framebuffer.GetWidth() && height <= framebuffer.GetHeight());
+
+    const Vec3* colorBuffer = framebuffer.GetColorBuffer();
+    const int fWidth = framebuffer.GetWidth();
+    const int fHeight = framebuffer.GetHeight();
+
+    constexpr int minRowsPerBand = 16;
+    ThreadPool::Instance().ParallelFor(0, height, [&](const int rowBegin, const int rowEnd)
+    {
+        for (int i = rowBegin; i < rowEnd; i++)
+        {
+            // 帧缓存的 y 轴向上, 图像自上而下存储
+            const Vec3* srcRow = colorBuffer + (fHeight - 1 - i) * fWidth;
+            ConvertRowToBGRA8(dst + i * dstPitch, srcRow, width, dither ? i : -1);
+        }
+    }, minRowsPerBand);
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Framebuffer.h"
+#include "Maths.h"
+
+#include <cstdint>
+
+namespace RGS {
+
+/**
+ * @brief 将一行浮点颜色转换为 BGRA8 (限制到 [0, 1], 缩放到 [0, 255] 并四舍五入, A 固定为 255)
+ * @param dst 输出像素, 每像素 4 字节, 内存顺序为 B G R A
+ * @param src 输入颜色
+ * @param count 像素数目
+ * @param ditherRow 有序抖动使用的行号, 小于 0 表示不抖动
+*/
+void ConvertRowToBGRA8(uint8_t* dst, const Vec3* src, const int count, const int ditherRow = -1);
+
+/**
+ * @brief 将帧缓存转换为自上而下存储的 BGRA8 图像(垂直翻转), 按行带并行执行
+ * @param dst 输出图像
+ * @param dstPitch 输出图像每行字节数
+ * @param framebuffer 单采样帧缓存
+ * @param width 转换的宽度
+ * @param height 转换的高度
+ * @param dither 是否启用有序抖动
+*/
+void ConvertFramebufferToBGRA8(uint8_t* dst,
+                                const int dstPitch,
+                                const Framebuffer& framebuffer,
+                                const int width,
+                                const int height,
+                                const bool dither = false);
+
+}
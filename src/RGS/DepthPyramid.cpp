@@ -0,0 +1,97 @@
+#include "DepthPyramid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace RGS {
+
+template<typename depth_func_t>
+void DepthPyramid::Build(const int width, const int height, depth_func_t&& getDepth)
+{
+    m_Width = width;
+    m_Height = height;
+    m_Levels.clear();
+    if (width <= 0 || height <= 0)
+        return;
+
+    Level base { width, height, std::vector<float>((size_t)width * height) };
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+            base.Depth[(size_t)y * width + x] = getDepth(x, y);
+    }
+    m_Levels.push_back(std::move(base));
+
+    // 尺寸为奇数时向上取整, 边缘的纹素只合并存在的部分, 每个纹素仍覆盖 2^level 大小的像素块
+    while (m_Levels.back().Width > 1 || m_Levels.back().Height > 1)
+    {
+        const Level& previous = m_Levels.back();
+        Level level { (previous.Width + 1) / 2, (previous.Height + 1) / 2, {} };
+        level.Depth.resize((size_t)level.Width * level.Height);
+        for (int y = 0; y < level.Height; y++)
+        {
+            const int y0 = y * 2;
+            const int y1 = std::min(y0 + 1, previous.Height - 1);
+            for (int x = 0; x < level.Width; x++)
+            {
+                const int x0 = x * 2;
+                const int x1 = std::min(x0 + 1, previous.Width - 1);
+                const float* row0 = previous.Depth.data() + (size_t)y0 * previous.Width;
+                const float* row1 = previous.Depth.data() + (size_t)y1 * previous.Width;
+                level.Depth[(size_t)y * level.Width + x] = std::max(std::max(row0[x0], row0[x1]), std::max(row1[x0], row1[x1]));
+            }
+        }
+        m_Levels.push_back(std::move(level));
+    }
+}
+
+void DepthPyramid::Build(const Framebuffer& framebuffer)
+{
+    const int sampleCount = framebuffer.GetSampleCount();
+    Build(framebuffer.GetWidth(), framebuffer.GetHeight(), [&](const int x, const int y)
+        {
+            float depth = framebuffer.GetSampleDepth(x, y, 0);
+            for (int i = 1; i < sampleCount; i++)
+                depth = std::max(depth, framebuffer.GetSampleDepth(x, y, i));
+            return depth;
+        });
+}
+
+void DepthPyramid::Build(const GBuffer& gbuffer)
+{
+    Build(gbuffer.GetWidth(), gbuffer.GetHeight(), [&](const int x, const int y) { return gbuffer.GetDepth(x, y); });
+}
+
+bool DepthPyramid::IsOccluded(float minX, float minY, float maxX, float maxY, const float depth) const
+{
+    if (m_Levels.empty())
+        return false;
+    minX = std::max(minX, 0.0f);
+    minY = std::max(minY, 0.0f);
+    maxX = std::min(maxX, (float)m_Width - 1.0f);
+    maxY = std::min(maxY, (float)m_Height - 1.0f);
+    if (minX > maxX || minY > maxY)
+        return false;
+
+    // 选择矩形最多覆盖 2x2 个纹素的层级
+    const float size = std::max(maxX - minX, maxY - minY);
+    int levelIndex = size > 1.0f ? (int)std::ceil(std::log2(size)) : 0;
+    levelIndex = std::min(levelIndex, (int)m_Levels.size() - 1);
+    const Level& level = m_Levels[levelIndex];
+
+    const int x0 = (int)minX >> levelIndex;
+    const int y0 = (int)minY >> levelIndex;
+    const int x1 = std::min((int)maxX >> levelIndex, level.Width - 1);
+    const int y1 = std::min((int)maxY >> levelIndex, level.Height - 1);
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            if (level.Depth[(size_t)y * level.Width + x] >= depth)
+                return false;
+        }
+    }
+    return true;
+}
+
+}
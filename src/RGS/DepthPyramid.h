@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Framebuffer.h"
+#include "GBuffer.h"
+
+#include <vector>
+
+namespace RGS {
+
+// 深度金字塔(Hi-Z): 第 0 级为每个像素的最远深度, 之后每一级保存上一级 2x2 区域的最大深度
+// 用于保守的遮挡查询: 物体的最近深度比覆盖区域内的最远深度还远时一定被遮挡
+class DepthPyramid
+{
+public:
+    /**
+     * @brief 由已完成渲染的深度缓冲构建金字塔, 多重采样时取各采样的最远深度
+    */
+    void Build(const Framebuffer& framebuffer);
+    void Build(const GBuffer& gbuffer);
+    void Reset() { m_Levels.clear(); }
+
+    bool IsValid() const { return !m_Levels.empty(); }
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    int GetLevelCount() const { return (int)m_Levels.size(); }
+
+    /**
+     * @brief 屏幕矩形是否被完全遮挡
+     * @param minX, minY, maxX, maxY 屏幕像素矩形, 超出屏幕的部分被截取
+     * @param depth 被测物体的最近深度([0, 1])
+     * @return 矩形内所有像素的深度都比 depth 更近时返回 true
+    */
+    bool IsOccluded(float minX, float minY, float maxX, float maxY, const float depth) const;
+
+private:
+    struct Level
+    {
+        int Width;
+        int Height;
+        std::vector<float> Depth;
+    };
+
+    template<typename depth_func_t>
+    void Build(const int width, const int height, depth_func_t&& getDepth);
+
+private:
+    int m_Width = 0;
+    int m_Height = 0;
+    std::vector<Level> m_Levels;
+};
+
+}
@@ -1,15 +1,19 @@
 #include "Base.h"
 #include "Framebuffer.h"
 
+#include <immintrin.h>
+
 using namespace RGS;
 
-Framebuffer::Framebuffer(const int width, const int height)
-    :m_Width(width), m_Height(height)
+Framebuffer::Framebuffer(const int width, const int height, const int sampleCount)
+    :m_Width(width), m_Height(height), m_SampleCount(sampleCount)
 {
     ASSERT((width > 0) && (height > 0));
+    ASSERT((sampleCount == 1) || (sampleCount == 4));
     m_PixelSize = m_Width * m_Height;
-    m_ColorBuffer = new Vec3[m_PixelSize]();
-    m_DepthBuffer = new float[m_PixelSize]();
+    m_BufferSize = m_PixelSize * m_SampleCount;
+    m_ColorBuffer = new Vec3[m_BufferSize]();
+    m_DepthBuffer = new float[m_BufferSize]();
     Clear();
     ClearDepth();
 }
@@ -24,28 +28,31 @@ Framebuffer::~Framebuffer()
 
 void Framebuffer::SetColor(const int x, const int y, const Vec3& color)
 {
-    if ((x < 0) || (x >= m_Width) || (y < 0) || (y >= m_Height))
+    if (!IsInside(x, y))
     {
         ASSERT(false);
         return;
     }
     else
     {
-        int index = GetPixelIndex(x, y);
-        m_ColorBuffer[index] = color;
+        int index = GetSampleIndex(x, y, 0);
+        for (int i = 0; i < m_SampleCount; i++)
+        {
+            m_ColorBuffer[index + i] = color;
+        }
     }
 }
 
 Vec3 Framebuffer::GetColor(const int x, const int y) const
 {
-    if ((x < 0) || (x >= m_Width) || (y < 0) || (y >= m_Height))
+    if (!IsInside(x, y))
     {
         ASSERT(false);
         return {0.0f, 0.0f, 0.0f};
     }
     else
     {
-        int index = GetPixelIndex(x, y);
+        int index = GetSampleIndex(x, y, 0);
         return m_ColorBuffer[index];
     }
 }
@@ -53,35 +60,78 @@ Vec3 Framebuffer::GetColor(const int x, const int y) const
 void Framebuffer::SetDepth(const int x, const int y, const float depth)
 {
 
-    if ((x < 0) || (x >= m_Width) || (y < 0) || (y >= m_Height))
+    if (!IsInside(x, y))
     {
         ASSERT(false);
         return;
     }
     else
     {
-        int index = GetPixelIndex(x, y);
-        m_DepthBuffer[index] = depth;
+        int index = GetSampleIndex(x, y, 0);
+        for (int i = 0; i < m_SampleCount; i++)
+        {
+            m_DepthBuffer[index + i] = depth;
+        }
     }
 }
 
 float Framebuffer::GetDepth(const int x, const int y) const
 {
-    if ((x < 0) || (x >= m_Width) || (y < 0) || (y >= m_Height))
+    if (!IsInside(x, y))
     {
         ASSERT(false);
         return 0.0f;
     }
     else
     {
-        int index = GetPixelIndex(x, y);
+        int index = GetSampleIndex(x, y, 0);
         return m_DepthBuffer[index];
     }
 }
 
+void Framebuffer::SetSampleColor(const int x, const int y, const int sample, const Vec3& color)
+{
+    if (!IsInside(x, y) || (sample < 0) || (sample >= m_SampleCount))
+    {
+        ASSERT(false);
+        return;
+    }
+    m_ColorBuffer[GetSampleIndex(x, y, sample)] = color;
+}
+
+Vec3 Framebuffer::GetSampleColor(const int x, const int y, const int sample) const
+{
+    if (!IsInside(x, y) || (sample < 0) || (sample >= m_SampleCount))
+    {
+        ASSERT(false);
+        return { 0.0f, 0.0f, 0.0f };
+    }
+    return m_ColorBuffer[GetSampleIndex(x, y, sample)];
+}
+
+void Framebuffer::SetSampleDepth(const int x, const int y, const int sample, const float depth)
+{
+    if (!IsInside(x, y) || (sample < 0) || (sample >= m_SampleCount))
+    {
+        ASSERT(false);
+        return;
+    }
+    m_DepthBuffer[GetSampleIndex(x, y, sample)] = depth;
+}
+
+float Framebuffer::GetSampleDepth(const int x, const int y, const int sample) const
+{
+    if (!IsInside(x, y) || (sample < 0) || (sample >= m_SampleCount))
+    {
+        ASSERT(false);
+        return 0.0f;
+    }
+    return m_DepthBuffer[GetSampleIndex(x, y, sample)];
+}
+
 void Framebuffer::Clear(const Vec3& color)
 {
-    for (int i = 0; i < m_PixelSize; i++)
+    for (int i = 0; i < m_BufferSize; i++)
     {
         m_ColorBuffer[i] = color;
     }
@@ -89,8 +139,41 @@ void Framebuffer::Clear(const Vec3& color)
 
 void Framebuffer::ClearDepth(float depth)
 {
-    for (int i = 0; i < m_PixelSize; i++)
+    for (int i = 0; i < m_BufferSize; i++)
     {
         m_DepthBuffer[i] = depth;
     }
-}
\ No newline at end of file
+}
+
+void Framebuffer::Resolve(Framebuffer& target) const
+{
+    ASSERT((target.m_Width == m_Width) && (target.m_Height == m_Height) && (target.m_SampleCount == 1));
+
+    if (m_SampleCount == 1)
+    {
+        for (int i = 0; i < m_PixelSize; i++)
+        {
+            target.m_ColorBuffer[i] = m_ColorBuffer[i];
+        }
+        return;
+    }
+
+    // 4 个采样的 Vec3 连续存放: r0 g0 b0 r1 | g1 b1 r2 g2 | b2 r3 g3 b3
+    // 每个采样用一次非对齐加载取出 rgb(第 4 个分量不使用), 相加后乘 1/4
+    // 最后一个像素的第 4 次加载会越过缓冲末尾, 单独用标量处理
+    const float* src = (const float*)m_ColorBuffer;
+    float* dst = (float*)target.m_ColorBuffer;
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    const int simdPixelNum = m_PixelSize - 1;
+    for (int i = 0; i < simdPixelNum; i++)
+    {
+        const float* samples = src + i * 12;
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(samples), _mm_loadu_ps(samples + 3)),
+                                _mm_add_ps(_mm_loadu_ps(samples + 6), _mm_loadu_ps(samples + 9)));
+        // 写入 4 个 float, 多出的一个落在下一个像素的 X 上, 随后会被覆盖
+        _mm_storeu_ps(dst + i * 3, _mm_mul_ps(sum, quarter));
+    }
+
+    const Vec3* samples = m_ColorBuffer + simdPixelNum * 4;
+    target.m_ColorBuffer[simdPixelNum] = (samples[0] + samples[1] + samples[2] + samples[3]) * 0.25f;
+}
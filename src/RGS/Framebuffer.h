@@ -6,33 +6,61 @@ namespace RGS
 {
 
 // Learn Framebuffer: https://learnopengl-cn.github.io/04%20Advanced%20OpenGL/05%20Framebuffers/
+// Learn Anti Aliasing: https://learnopengl-cn.github.io/04%20Advanced%20OpenGL/11%20Anti%20Aliasing/
 class Framebuffer
 {
 public:
-    Framebuffer(const int width, const int height);
+    /**
+     * @param sampleCount 每个像素的采样数, 1 为普通帧缓存, 4 为 4x MSAA
+    */
+    Framebuffer(const int width, const int height, const int sampleCount = 1);
     ~Framebuffer();
 
     int GetWidth() const { return m_Width; }
     int GetHeight() const { return m_Height; }
+    int GetSampleCount() const { return m_SampleCount; }
 
+    // 像素级访问: Set 写入像素的所有采样, Get 读取第 0 个采样
     void SetColor(const int x, const int y, const Vec3& color);
     Vec3 GetColor(const int x, const int y) const;
     void SetDepth(const int x, const int y, const float depth);
     float GetDepth(const int x, const int y) const;
 
+    // 采样级访问
+    void SetSampleColor(const int x, const int y, const int sample, const Vec3& color);
+    Vec3 GetSampleColor(const int x, const int y, const int sample) const;
+    void SetSampleDepth(const int x, const int y, const int sample, const float depth);
+    float GetSampleDepth(const int x, const int y, const int sample) const;
+
+    // 直接访问颜色/深度缓冲(按行存储, 每个像素连续存放 sampleCount 个采样, 不做边界检查), 用于光栅化与显示的快速路径
+    Vec3* GetColorBuffer() { return m_ColorBuffer; }
+    const Vec3* GetColorBuffer() const { return m_ColorBuffer; }
+    float* GetDepthBuffer() { return m_DepthBuffer; }
+    const float* GetDepthBuffer() const { return m_DepthBuffer; }
+
     void Clear(const Vec3& color = { 0.0f, 0.0f, 0.0f });
     void ClearDepth(float depth = 1.0f);
 
+    /**
+     * @brief 将多重采样求平均, 写入单采样的目标帧缓存
+     * @param target 目标帧缓存, 尺寸相同且 sampleCount 为 1
+    */
+    void Resolve(Framebuffer& target) const;
+
 private:
     int GetPixelIndex(const int x, const int y) const { return y * m_Width + x; }
+    int GetSampleIndex(const int x, const int y, const int sample) const { return (y * m_Width + x) * m_SampleCount + sample; }
+    bool IsInside(const int x, const int y) const { return (x >= 0) && (x < m_Width) && (y >= 0) && (y < m_Height); }
 
 private:
     int m_Width;
     int m_Height;
-    int m_PixelSize;    // 每个像素的大小, 3 * sizeof(float) = 12
+    int m_SampleCount;  // 每个像素的采样数
+    int m_PixelSize;    // 像素数量
+    int m_BufferSize;   // 采样数量, m_PixelSize * m_SampleCount
 
     float* m_DepthBuffer;   // 深度缓冲
     Vec3* m_ColorBuffer;    // 颜色缓冲
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,82 @@
+#include "Frustum.h"
+
+#include <emmintrin.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace RGS {
+
+AABB Union(const AABB& left, const AABB& right)
+{
+    return { { std::min(left.Min.X, right.Min.X), std::min(left.Min.Y, right.Min.Y), std::min(left.Min.Z, right.Min.Z) },
+             { std::max(left.Max.X, right.Max.X), std::max(left.Max.Y, right.Max.Y), std::max(left.Max.Z, right.Max.Z) } };
+}
+
+AABB Expand(const AABB& box, const float margin)
+{
+    Vec3 offset { margin, margin, margin };
+    return { box.Min - offset, box.Max + offset };
+}
+
+AABB TransformAABB(const AABB& box, const Mat4& transform)
+{
+    Vec3 center = transform * Vec4{ box.GetCenter(), 1.0f };
+    Vec3 extent = box.GetExtent();
+    const float (&m)[4][4] = transform.M;
+    Vec3 worldExtent {
+        std::abs(m[0][0]) * extent.X + std::abs(m[0][1]) * extent.Y + std::abs(m[0][2]) * extent.Z,
+        std::abs(m[1][0]) * extent.X + std::abs(m[1][1]) * extent.Y + std::abs(m[1][2]) * extent.Z,
+        std::abs(m[2][0]) * extent.X + std::abs(m[2][1]) * extent.Y + std::abs(m[2][2]) * extent.Z };
+    return { center - worldExtent, center + worldExtent };
+}
+
+Frustum::Frustum(const Mat4& viewProj)
+{
+    Vec4 planes[6];
+    Mat4FrustumPlanes(viewProj, planes);
+    for (int i = 0; i < 8; i++)
+    {
+        // 补齐的平面法线为 0, 距离为最大值
+        const Vec4 plane = i < 6 ? planes[i] : Vec4{ 0.0f, 0.0f, 0.0f, FLT_MAX };
+        m_NormalX[i] = plane.X;
+        m_NormalY[i] = plane.Y;
+        m_NormalZ[i] = plane.Z;
+        m_Distance[i] = plane.W;
+    }
+}
+
+FrustumTestResult Frustum::Test(const AABB& box) const
+{
+    /* 包围盒中心到平面的距离 d 与包围盒在平面法线上的投影半径 r: d < -r 时在平面外, d >= r 时在平面内 */
+    const Vec3 center = box.GetCenter();
+    const Vec3 extent = box.GetExtent();
+    const __m128 cx = _mm_set1_ps(center.X);
+    const __m128 cy = _mm_set1_ps(center.Y);
+    const __m128 cz = _mm_set1_ps(center.Z);
+    const __m128 ex = _mm_set1_ps(extent.X);
+    const __m128 ey = _mm_set1_ps(extent.Y);
+    const __m128 ez = _mm_set1_ps(extent.Z);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    int outside = 0;
+    int inside = 0xFF;
+    for (int i = 0; i < 8; i += 4)
+    {
+        __m128 nx = _mm_load_ps(m_NormalX + i);
+        __m128 ny = _mm_load_ps(m_NormalY + i);
+        __m128 nz = _mm_load_ps(m_NormalZ + i);
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+                                     _mm_add_ps(_mm_mul_ps(nz, cz), _mm_load_ps(m_Distance + i)));
+        __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), ex), _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey)),
+                                   _mm_mul_ps(_mm_andnot_ps(signMask, nz), ez));
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps())) << i;
+        inside &= (_mm_movemask_ps(_mm_cmpge_ps(distance, radius)) << i) | ~(0xF << i);
+    }
+
+    if (outside)
+        return FrustumTestResult::OUTSIDE;
+    return inside == 0xFF ? FrustumTestResult::INSIDE : FrustumTestResult::INTERSECT;
+}
+
+}
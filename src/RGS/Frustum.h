@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Maths.h"
+
+namespace RGS {
+
+// 轴对齐包围盒
+struct AABB
+{
+    Vec3 Min { 0.0f, 0.0f, 0.0f };
+    Vec3 Max { 0.0f, 0.0f, 0.0f };
+
+    Vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+    Vec3 GetExtent() const { return (Max - Min) * 0.5f; }
+    float GetSurfaceArea() const
+    {
+        Vec3 size = Max - Min;
+        return 2.0f * (size.X * size.Y + size.Y * size.Z + size.Z * size.X);
+    }
+    bool Contains(const AABB& other) const
+    {
+        return Min.X <= other.Min.X && Min.Y <= other.Min.Y && Min.Z <= other.Min.Z
+            && Max.X >= other.Max.X && Max.Y >= other.Max.Y && Max.Z >= other.Max.Z;
+    }
+    bool Overlaps(const AABB& other) const
+    {
+        return Min.X <= other.Max.X && Min.Y <= other.Max.Y && Min.Z <= other.Max.Z
+            && Max.X >= other.Min.X && Max.Y >= other.Min.Y && Max.Z >= other.Min.Z;
+    }
+};
+
+AABB Union(const AABB& left, const AABB& right);
+AABB Expand(const AABB& box, const float margin);        // 各方向扩大 margin
+/**
+ * @brief 变换后的包围盒: 中心按矩阵变换, 半长按矩阵元素的绝对值变换, 结果仍包含变换后的原包围盒
+*/
+AABB TransformAABB(const AABB& box, const Mat4& transform);
+
+enum class FrustumTestResult
+{
+    OUTSIDE,        // 完全在视锥外
+    INTERSECT,      // 与视锥边界相交
+    INSIDE,         // 完全在视锥内
+};
+
+// 视锥, 平面按 SoA 存放, 一次 SSE 运算测试包围盒与 4 个平面
+class Frustum
+{
+public:
+    Frustum() = default;
+    /**
+     * @param viewProj 观察投影矩阵, 平面位于世界空间
+    */
+    explicit Frustum(const Mat4& viewProj);
+
+    /**
+     * @brief 包围盒与视锥的关系: 包围盒在某个平面外时为 OUTSIDE, 在所有平面内时为 INSIDE
+     *        只比较平面, 视锥角落附近的少数包围盒可能被保守地判为相交
+    */
+    FrustumTestResult Test(const AABB& box) const;
+
+private:
+    // 6 个平面补齐到 8 个, 补齐的平面对任何包围盒都在内侧
+    alignas(16) float m_NormalX[8] = {};
+    alignas(16) float m_NormalY[8] = {};
+    alignas(16) float m_NormalZ[8] = {};
+    alignas(16) float m_Distance[8] = {};
+};
+
+}
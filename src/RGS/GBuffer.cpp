@@ -0,0 +1,88 @@
+#include "Base.h"
+#include "GBuffer.h"
+
+using namespace RGS;
+
+GBuffer::GBuffer(const int width, const int height)
+    :m_Width(width), m_Height(height)
+{
+    ASSERT((width > 0) && (height > 0));
+    m_PixelSize = m_Width * m_Height;
+    m_TexelBuffer = new GBufferTexel[m_PixelSize]();
+    m_DepthBuffer = new float[m_PixelSize]();
+    Clear();
+    ClearDepth();
+}
+
+GBuffer::~GBuffer()
+{
+    delete[] m_TexelBuffer;
+    delete[] m_DepthBuffer;
+    m_TexelBuffer = nullptr;
+    m_DepthBuffer = nullptr;
+}
+
+void GBuffer::SetTexel(const int x, const int y, const GBufferTexel& texel)
+{
+    if ((x < 0) || (x >= m_Width) || (y < 0) || (y >= m_Height))
+    {
+        ASSERT(false);
+        return;
+    }
+    else
+    {
+        int index = GetPixelIndex(x, y);
+        m_TexelBuffer[index] = texel;
+    }
+}
+
+const GBufferTexel& GBuffer::GetTexel(const int x, const int y) const
+{
+    ASSERT((x >= 0) && (x < m_Width) && (y >= 0) && (y < m_Height));
+    int index = GetPixelIndex(x, y);
+    return m_TexelBuffer[index];
+}
+
+void GBuffer::SetDepth(const int x, const int y, const float depth)
+{
+    if ((x < 0) || (x >= m_Width) || (y < 0) || (y >= m_Height))
+    {
+        ASSERT(false);
+        return;
+    }
+    else
+    {
+        int index = GetPixelIndex(x, y);
+        m_DepthBuffer[index] = depth;
+    }
+}
+
+float GBuffer::GetDepth(const int x, const int y) const
+{
+    if ((x < 0) || (x >= m_Width) || (y < 0) || (y >= m_Height))
+    {
+        ASSERT(false);
+        return 0.0f;
+    }
+    else
+    {
+        int index = GetPixelIndex(x, y);
+        return m_DepthBuffer[index];
+    }
+}
+
+void GBuffer::Clear()
+{
+    for (int i = 0; i < m_PixelSize; i++)
+    {
+        m_TexelBuffer[i] = GBufferTexel();
+    }
+}
+
+void GBuffer::ClearDepth(float depth)
+{
+    for (int i = 0; i < m_PixelSize; i++)
+    {
+        m_DepthBuffer[i] = depth;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Maths.h"
+
+namespace RGS
+{
+
+// 几何缓冲中单个像素的表面信息
+struct GBufferTexel
+{
+    Vec3 WorldPos;                  // 世界坐标位置
+    Vec3 Normal;                    // 世界坐标下的法线(已归一化)
+    Vec3 Albedo;                    // 漫反射颜色
+    Vec3 SpecularStrength;          // 镜面反射强度
+};
+
+// Learn Deferred Shading: https://learnopengl-cn.github.io/05%20Advanced%20Lighting/08%20Deferred%20Shading/
+class GBuffer
+{
+public:
+    GBuffer(const int width, const int height);
+    ~GBuffer();
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+
+    void SetTexel(const int x, const int y, const GBufferTexel& texel);
+    const GBufferTexel& GetTexel(const int x, const int y) const;
+    void SetDepth(const int x, const int y, const float depth);
+    float GetDepth(const int x, const int y) const;
+
+    void Clear();
+    void ClearDepth(float depth = 1.0f);
+
+private:
+    int GetPixelIndex(const int x, const int y) const { return y * m_Width + x; }
+
+private:
+    int m_Width;
+    int m_Height;
+    int m_PixelSize;    // 像素数量
+
+    float* m_DepthBuffer;           // 深度缓冲
+    GBufferTexel* m_TexelBuffer;    // 表面信息缓冲
+};
+
+}
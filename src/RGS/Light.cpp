@@ -0,0 +1,85 @@
+#include "Light.h"
+
+#include "Base.h"
+#include "Maths.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace RGS {
+
+float GetLightAttenuation(const Light& light, const float distance)
+{
+    if (light.Range <= 0.0f)
+        return 1.0f;
+
+    // (1 - (d/r)^2)^2, 在 d = r 处连续衰减到 0
+    float ratio = distance / light.Range;
+    float falloff = Clamp(1.0f - ratio * ratio, 0.0f, 1.0f);
+    return falloff * falloff;
+}
+
+float GetSpotIntensity(const Light& light, const Vec3& lightDir)
+{
+    if (light.Type != LightType::SPOT)
+        return 1.0f;
+
+    // Learn Light casters: https://learnopengl-cn.github.io/02%20Lighting/05%20Light%20casters/
+    float theta = -Dot(lightDir, light.Dir);
+    float epsilon = light.InnerCutOff - light.OuterCutOff;
+    return Clamp((theta - light.OuterCutOff) / epsilon, 0.0f, 1.0f);
+}
+
+bool GetLightScreenRect(ScreenRect& rect, const Light& light, const Mat4& viewProj, const int width, const int height)
+{
+    rect = { 0, width - 1, 0, height - 1 };
+    if (light.Range <= 0.0f)
+        return true;
+
+    // 聚光灯同样使用包围球, 保守但足够简单
+    // 将包围球的 AABB 八个角点投影到屏幕, 取其包围矩形
+    float minX = 1.0f, maxX = -1.0f, minY = 1.0f, maxY = -1.0f;
+    int behindNum = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        Vec4 corner = {
+            light.Pos.X + ((i & 1) ? light.Range : -light.Range),
+            light.Pos.Y + ((i & 2) ? light.Range : -light.Range),
+            light.Pos.Z + ((i & 4) ? light.Range : -light.Range),
+            1.0f
+        };
+        Vec4 clipPos = viewProj * corner;
+        if (clipPos.W <= EPSILON)
+        {
+            behindNum++;
+            continue;
+        }
+        float x = clipPos.X / clipPos.W;
+        float y = clipPos.Y / clipPos.W;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+
+    if (behindNum == 8)     // 完全在相机后方
+        return false;
+    if (behindNum > 0)      // 包围盒跨越相机平面, 保守地覆盖整个屏幕
+        return true;
+
+    if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+        return false;
+
+    minX = Clamp(minX, -1.0f, 1.0f);
+    maxX = Clamp(maxX, -1.0f, 1.0f);
+    minY = Clamp(minY, -1.0f, 1.0f);
+    maxY = Clamp(maxY, -1.0f, 1.0f);
+
+    rect.MinX = std::max(0, (int)std::floor((minX + 1.0f) * 0.5f * width));
+    rect.MaxX = std::min(width - 1, (int)std::ceil((maxX + 1.0f) * 0.5f * width));
+    rect.MinY = std::max(0, (int)std::floor((minY + 1.0f) * 0.5f * height));
+    rect.MaxY = std::min(height - 1, (int)std::ceil((maxY + 1.0f) * 0.5f * height));
+    return rect.MinX <= rect.MaxX && rect.MinY <= rect.MaxY;
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "RGS/Maths.h"
+
+namespace RGS {
+
+enum class LightType
+{
+    POINT,          // 点光源
+    SPOT,           // 聚光灯
+};
+
+struct Light
+{
+    LightType Type = LightType::POINT;      // 光源类型
+    Vec3 Pos { 0.0f, 1.0f, 2.0f };          // 光源位置
+    Vec3 Dir { 0.0f, -1.0f, 0.0f };         // 聚光灯照射方向(已归一化)
+    Vec3 Diffuse { 0.5f, 0.5f, 0.5f };      // 漫反射光颜色
+    Vec3 Specular { 1.0f, 1.0f, 1.0f };     // 镜面反射光颜色
+    float Range = 0.0f;                     // 影响半径, <= 0 表示无衰减(影响整个屏幕)
+    float InnerCutOff = 0.9763f;            // 聚光灯内切光角余弦值, cos(12.5°)
+    float OuterCutOff = 0.9537f;            // 聚光灯外切光角余弦值, cos(17.5°)
+};
+
+struct ScreenRect { int MinX, MaxX, MinY, MaxY; };     // 屏幕空间矩形(闭区间)
+
+/**
+ * @brief 计算光源衰减, 在 Range 处平滑衰减到 0
+ * @param light 光源
+ * @param distance 片段到光源的距离
+*/
+float GetLightAttenuation(const Light& light, const float distance);
+/**
+ * @brief 计算聚光灯的边缘衰减, 点光源恒为 1
+ * @param light 光源
+ * @param lightDir 片段指向光源的方向(已归一化)
+*/
+float GetSpotIntensity(const Light& light, const Vec3& lightDir);
+
+/**
+ * @brief 计算光源影响范围(包围球)在屏幕上的矩形
+ * @param rect 输出屏幕矩形
+ * @param light 光源
+ * @param viewProj 观察投影矩阵
+ * @param width 屏幕宽度
+ * @param height 屏幕高度
+ * @return 光源是否可能影响屏幕上的像素
+*/
+bool GetLightScreenRect(ScreenRect& rect, const Light& light, const Mat4& viewProj, const int width, const int height);
+
+}
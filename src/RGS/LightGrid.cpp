@@ -0,0 +1,89 @@
+#include "LightGrid.h"
+
+#include "Base.h"
+
+#include <algorithm>
+
+namespace RGS {
+
+// 将观察空间 z 转换为深度缓冲中的深度
+static float ViewZToDepth(const float viewZ, const Mat4& proj)
+{
+    float clipZ = proj.M[2][2] * viewZ + proj.M[2][3];
+    float clipW = proj.M[3][2] * viewZ + proj.M[3][3];
+    if (clipW <= EPSILON)
+        return 0.0f;
+    return Clamp((clipZ / clipW + 1.0f) * 0.5f, 0.0f, 1.0f);
+}
+
+void LightGrid::Build(const Framebuffer& depthBuffer, const std::vector<Light>& lights, const Mat4& view, const Mat4& proj)
+{
+    m_Width = depthBuffer.GetWidth();
+    m_Height = depthBuffer.GetHeight();
+    m_TileCountX = (m_Width + TILE_SIZE - 1) / TILE_SIZE;
+    m_TileCountY = (m_Height + TILE_SIZE - 1) / TILE_SIZE;
+    const int tileCount = m_TileCountX * m_TileCountY;
+
+    /* Tile Depth Bounds (每个块的最小/最大深度) */
+    std::vector<float> tileMinDepth(tileCount, 1.0f);
+    std::vector<float> tileMaxDepth(tileCount, 0.0f);
+    for (int y = 0; y < m_Height; y++)
+    {
+        const int rowStart = (y / TILE_SIZE) * m_TileCountX;
+        for (int x = 0; x < m_Width; x++)
+        {
+            float depth = depthBuffer.GetDepth(x, y);
+            if (depth >= 1.0f)      // 未被几何覆盖
+                continue;
+            const int tileIndex = rowStart + x / TILE_SIZE;
+            tileMinDepth[tileIndex] = std::min(tileMinDepth[tileIndex], depth);
+            tileMaxDepth[tileIndex] = std::max(tileMaxDepth[tileIndex], depth);
+        }
+    }
+
+    /* Light Binning (将光源放入与其相交的块) */
+    std::vector<std::vector<uint32_t>> tileLights(tileCount);
+    const Mat4 viewProj = proj * view;
+    for (uint32_t i = 0; i < (uint32_t)lights.size(); i++)
+    {
+        const Light& light = lights[i];
+        ScreenRect rect;
+        if (!GetLightScreenRect(rect, light, viewProj, m_Width, m_Height))
+            continue;
+
+        float lightMinDepth = 0.0f;
+        float lightMaxDepth = 1.0f;
+        if (light.Range > 0.0f)
+        {
+            // 观察空间中相机朝向 -Z, 包围球最近点 z + r, 最远点 z - r
+            float viewZ = (view * Vec4{ light.Pos, 1.0f }).Z;
+            lightMinDepth = ViewZToDepth(viewZ + light.Range, proj);
+            lightMaxDepth = ViewZToDepth(viewZ - light.Range, proj);
+        }
+
+        for (int tileY = rect.MinY / TILE_SIZE; tileY <= rect.MaxY / TILE_SIZE; tileY++)
+        {
+            for (int tileX = rect.MinX / TILE_SIZE; tileX <= rect.MaxX / TILE_SIZE; tileX++)
+            {
+                const int tileIndex = tileY * m_TileCountX + tileX;
+                if (tileMinDepth[tileIndex] > tileMaxDepth[tileIndex])      // 空块
+                    continue;
+                if (lightMinDepth > tileMaxDepth[tileIndex] || lightMaxDepth < tileMinDepth[tileIndex])
+                    continue;
+                tileLights[tileIndex].push_back(i);
+            }
+        }
+    }
+
+    /* Compaction (压缩为连续的索引数组) */
+    m_Tiles.resize(tileCount);
+    m_LightIndices.clear();
+    for (int i = 0; i < tileCount; i++)
+    {
+        m_Tiles[i].Offset = (uint32_t)m_LightIndices.size();
+        m_Tiles[i].Count = (uint32_t)tileLights[i].size();
+        m_LightIndices.insert(m_LightIndices.end(), tileLights[i].begin(), tileLights[i].end());
+    }
+}
+
+}
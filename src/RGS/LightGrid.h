@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Framebuffer.h"
+#include "Light.h"
+#include "Maths.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace RGS {
+
+// Forward+ 分块光源剔除: 深度预渲染后, 每个屏幕块只保留包围范围与块深度区间相交的光源
+class LightGrid
+{
+public:
+    static constexpr int TILE_SIZE = 16;      // 屏幕块大小(像素)
+
+    /**
+     * @brief 构建分块光源列表
+     * @param depthBuffer 已完成深度预渲染的帧缓存
+     * @param lights 光源列表
+     * @param view 观察矩阵
+     * @param proj 投影矩阵
+    */
+    void Build(const Framebuffer& depthBuffer, const std::vector<Light>& lights, const Mat4& view, const Mat4& proj);
+
+    /**
+     * @brief 获取像素所在屏幕块的光源索引
+     * @param x 像素 x 坐标
+     * @param y 像素 y 坐标
+     * @param count 输出光源数目
+     * @return 光源索引数组, 索引对应 Build 时传入的光源列表
+    */
+    const uint32_t* GetTileLights(const int x, const int y, int& count) const
+    {
+        int tileX = std::min(std::max(x, 0), m_Width - 1) / TILE_SIZE;
+        int tileY = std::min(std::max(y, 0), m_Height - 1) / TILE_SIZE;
+        const Tile& tile = m_Tiles[tileY * m_TileCountX + tileX];
+        count = (int)tile.Count;
+        return m_LightIndices.data() + tile.Offset;
+    }
+
+private:
+    struct Tile 
+    {
+        uint32_t Offset;    // 在 m_LightIndices 中的起始位置
+        uint32_t Count;     // 光源数目
+    };
+
+    int m_Width = 0;
+    int m_Height = 0;
+    int m_TileCountX = 0;
+    int m_TileCountY = 0;
+
+    std::vector<Tile> m_Tiles;                  // 屏幕块
+    std::vector<uint32_t> m_LightIndices;       // 紧凑排列的光源索引
+};
+
+}
@@ -233,6 +233,48 @@ Mat4 Mat4Perspective(float fovy, float aspect, float near, float far)
     return m;
 }
 
+Mat4 Mat4NormalMatrix(const Mat4& model)
+{
+    // 逆转置等于伴随矩阵的转置(代数余子式矩阵)除以行列式
+    const float (&m)[4][4] = model.M;
+    Mat4 normal = Mat4Identity();
+    normal.M[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    normal.M[0][1] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    normal.M[0][2] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+    normal.M[1][0] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+    normal.M[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+    normal.M[1][2] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+    normal.M[2][0] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+    normal.M[2][1] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+    normal.M[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+    float det = m[0][0] * normal.M[0][0] + m[0][1] * normal.M[0][1] + m[0][2] * normal.M[0][2];
+    ASSERT(det != 0.0f);
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            normal.M[i][j] /= det;
+        }
+    }
+    return normal;
+}
+
+void Mat4FrustumPlanes(const Mat4& mvp, Vec4(&planes)[6])
+{
+    // 裁剪空间中 -w <= x, y, z <= w, 即 (第 3 行 ± 第 i 行)·p >= 0, 依次为左右、下上、近远
+    for (int i = 0; i < 3; i++)
+    {
+        for (int sign = 0; sign < 2; sign++)
+        {
+            const float s = sign == 0 ? 1.0f : -1.0f;
+            Vec4 plane { mvp.M[3][0] + s * mvp.M[i][0], mvp.M[3][1] + s * mvp.M[i][1],
+                        mvp.M[3][2] + s * mvp.M[i][2], mvp.M[3][3] + s * mvp.M[i][3] };
+            float length = (float)std::sqrt(plane.X * plane.X + plane.Y * plane.Y + plane.Z * plane.Z);
+            planes[i * 2 + sign] = length > 0.0f ? plane / length : plane;
+        }
+    }
+}
+
 float Lerp(const float start, const float end, const float t)
 {
     return end * t + start * (1.0f - t);
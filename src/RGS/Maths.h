@@ -144,6 +144,8 @@ Mat4 Mat4RotateZ(float angle);      // z轴旋转矩阵
 Mat4 Mat4LookAt(const Vec3& xAxis, const Vec3& yAxis, const Vec3& zAxis, const Vec3& eye);      // 视点矩阵
 Mat4 Mat4LookAt(const Vec3& eye, const Vec3& target, const Vec3& up);       // 视点矩阵
 Mat4 Mat4Perspective(float fovy, float aspect, float near, float far);      // 透视投影矩阵
+Mat4 Mat4NormalMatrix(const Mat4& model);           // 法线矩阵: 模型矩阵左上 3x3 的逆转置, 非均匀缩放时法线仍垂直于表面
+void Mat4FrustumPlanes(const Mat4& mvp, Vec4(&planes)[6]);      // 由(模型)观察投影矩阵提取视锥平面 (法线, 距离), 法线指向内部且已归一化
 
 // 线性插值， t 取值范围 [0, 1]
 float Lerp(const float start, const float end, const float t);
@@ -0,0 +1,478 @@
+#include "Base.h"
+#include "MappedFile.h"
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace RGS {
+
+namespace {
+
+// .rgsmesh 文件头, 之后依次为 LodCount 个 MeshLod、顶点缓冲、索引缓冲与网格簇
+struct CookedMeshHeader
+{
+    char Magic[4];          // "RGSM"
+    uint32_t Version;
+    uint32_t VertexSize;    // sizeof(BlinnVertex), 顶点布局改变时缓存失效
+    uint32_t LodCount;
+    uint32_t Flags;         // COOKED_FLAG_*
+    uint32_t Reserved;
+    uint64_t VertexCount;
+    uint64_t IndexCount;
+    uint64_t MeshletCount;
+    uint64_t VertexOffset;  // 顶点缓冲相对文件起始的偏移, 按 COOKED_ALIGNMENT 对齐
+    uint64_t IndexOffset;   // 索引缓冲相对文件起始的偏移, 按 COOKED_ALIGNMENT 对齐
+    uint64_t MeshletOffset; // 网格簇相对文件起始的偏移, 按 COOKED_ALIGNMENT 对齐
+    float BoundsMin[3];
+    float BoundsMax[3];
+    uint64_t SourceSize;    // 源文件字节数
+    int64_t SourceTime;     // 源文件修改时间
+    uint64_t SourceHash;    // 源文件内容哈希
+};
+
+constexpr char COOKED_MAGIC[4] = { 'R', 'G', 'S', 'M' };
+constexpr uint32_t COOKED_VERSION = 4;
+constexpr uint32_t COOKED_FLAG_OPTIMIZED = 1;     // 网格已经过 Mesh::Optimize
+constexpr uint32_t COOKED_FLAG_LODS = 2;          // 细节层级由 Mesh::GenerateLods 生成
+constexpr uint32_t COOKED_FLAG_MESHLETS = 4;      // 包含 Mesh::BuildMeshlets 划分的网格簇
+constexpr uint64_t COOKED_ALIGNMENT = 64;
+
+struct SourceInfo
+{
+    uint64_t Size = 0;
+    int64_t Time = 0;
+};
+
+bool GetSourceInfo(const std::string& path, SourceInfo& info)
+{
+    std::error_code error;
+    info.Size = (uint64_t)std::filesystem::file_size(path, error);
+    if (error)
+        return false;
+    info.Time = (int64_t)std::filesystem::last_write_time(path, error).time_since_epoch().count();
+    return !error;
+}
+
+/**
+ * @brief 计算文件内容的 64 位哈希, 每次处理 8 字节
+*/
+uint64_t HashFile(const std::string& path)
+{
+    MappedFile file(path);
+    if (!file.IsValid())
+        return 0;
+    const uint8_t* data = file.GetData();
+    const size_t size = file.GetSize();
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 0xC4CEB9FE1A85EC53ull;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+/**
+ * @brief 改写缓存文件头中记录的源文件修改时间, 文件须未被映射
+*/
+bool WriteSourceTime(const std::string& path, const int64_t time)
+{
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file)
+        return false;
+    file.seekp(offsetof(CookedMeshHeader, SourceTime));
+    file.write((const char*)&time, sizeof(time));
+    return (bool)file;
+}
+
+inline uint64_t AlignOffset(const uint64_t offset)
+{
+    return (offset + COOKED_ALIGNMENT - 1) / COOKED_ALIGNMENT * COOKED_ALIGNMENT;
+}
+
+}
+
+Mesh::Mesh(const std::string& path, const MeshOptions& options)
+    : m_Path(path), m_Options(options)
+{
+    Init();
+}
+
+Mesh::Mesh(std::vector<BlinnVertex> vertices, std::vector<uint32_t> indices)
+    : m_VertexStorage(std::move(vertices)), m_IndexStorage(std::move(indices))
+{
+    ASSERT(m_IndexStorage.size() % 3 == 0);
+    InitStorage();
+}
+
+Mesh::~Mesh() = default;
+
+void Mesh::Init()
+{
+    const std::string extension = COOKED_EXTENSION;
+    if (m_Path.size() > extension.size() && m_Path.compare(m_Path.size() - extension.size(), extension.size(), extension) == 0)
+    {
+        bool loaded = InitCooked(m_Path, "");
+        ASSERT(loaded);
+        return;
+    }
+
+    // 缓存有效时直接映射, 否则解析 OBJ 并重新写入缓存(目录不可写时忽略)
+    const std::string cookedPath = m_Path + extension;
+    if (m_Options.UseCache && InitCooked(cookedPath, m_Path))
+        return;
+    InitObj();
+    InitStorage();
+    if (m_Options.Optimize)
+        Optimize();
+    if (m_Options.GenerateLods)
+        GenerateLods();
+    if (m_Options.BuildMeshlets)
+        BuildMeshlets();
+    if (!m_Options.UseCache)
+        return;
+
+    // 同一网格可能被多个线程同时加载, 临时文件名带上线程编号, 避免互相覆盖
+    const std::string tempPath = cookedPath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    if (SaveCooked(tempPath, m_Path))
+    {
+        std::error_code error;
+        std::filesystem::rename(tempPath, cookedPath, error);
+        if (error)
+            std::filesystem::remove(tempPath, error);
+    }
+}
+
+void Mesh::InitObj()
+{
+    ObjData obj;
+    bool loaded = ParseObj(m_Path, obj);
+    ASSERT(loaded);
+
+    const int positionNum = (int)obj.Positions.size();
+    const int texCoordNum = (int)obj.TexCoords.size();
+    const int normalNum = (int)obj.Normals.size();
+
+    /* 按 (位置, 纹理坐标, 法线) 索引去重, 同一位置的顶点串成链表, 链表通常只有几个顶点 */
+    constexpr uint32_t INVALID_INDEX = ~0u;
+    std::vector<uint32_t> positionHeads(positionNum, INVALID_INDEX);    // 每个位置的第一个顶点
+    std::vector<uint32_t> nextVertices;                                 // 同一位置的下一个顶点
+    std::vector<ObjIndex> vertexKeys;
+    std::vector<BlinnVertex>& vertices = m_VertexStorage;
+    std::vector<uint32_t>& indices = m_IndexStorage;
+    indices.resize(obj.Indices.size());
+    bool missingNormals = false;
+    for (size_t i = 0; i < obj.Indices.size(); i++)
+    {
+        const ObjIndex& index = obj.Indices[i];
+        ASSERT(index.Position >= 0 && index.Position < positionNum);
+        ASSERT(index.TexCoord < texCoordNum && index.Normal < normalNum);
+
+        uint32_t vertexIndex = positionHeads[index.Position];
+        while (vertexIndex != INVALID_INDEX)
+        {
+            const ObjIndex& key = vertexKeys[vertexIndex];
+            if (key.TexCoord == index.TexCoord && key.Normal == index.Normal)
+                break;
+            vertexIndex = nextVertices[vertexIndex];
+        }
+
+        if (vertexIndex == INVALID_INDEX)
+        {
+            vertexIndex = (uint32_t)vertices.size();
+            BlinnVertex vertex;
+            vertex.ModelPos = { obj.Positions[index.Position], 1.0f };
+            if (index.TexCoord >= 0)
+                vertex.TexCoord = obj.TexCoords[index.TexCoord];
+            vertex.ModelNormal = index.Normal >= 0 ? obj.Normals[index.Normal] : Vec3{ 0.0f, 0.0f, 0.0f };
+            missingNormals |= index.Normal < 0;
+            vertices.push_back(vertex);
+            vertexKeys.push_back(index);
+            nextVertices.push_back(positionHeads[index.Position]);
+            positionHeads[index.Position] = vertexIndex;
+        }
+        indices[i] = vertexIndex;
+    }
+
+    /* 缺少法线的顶点使用相邻三角形面积加权的平均法线 */
+    if (missingNormals)
+    {
+        std::vector<Vec3> faceNormalSums(vertices.size(), { 0.0f, 0.0f, 0.0f });
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            Vec3 p0 = vertices[indices[i]].ModelPos;
+            Vec3 p1 = vertices[indices[i + 1]].ModelPos;
+            Vec3 p2 = vertices[indices[i + 2]].ModelPos;
+            Vec3 faceNormal = Cross(p1 - p0, p2 - p0);      // 长度为面积的两倍
+            for (int j = 0; j < 3; j++)
+                faceNormalSums[indices[i + j]] = faceNormalSums[indices[i + j]] + faceNormal;
+        }
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            if (vertexKeys[i].Normal < 0)
+                vertices[i].ModelNormal = Normalize(faceNormalSums[i]);
+        }
+    }
+}
+
+MeshOptimizeStats Mesh::Optimize()
+{
+    ASSERT(!IsMapped(), "映射的网格不能优化");
+    ASSERT(m_Lods.size() == 1, "须在生成细节层级之前优化");
+    ASSERT(m_MeshletStorage.empty(), "须在划分网格簇之前优化");
+    std::vector<BlinnVertex>& vertices = m_VertexStorage;
+    std::vector<uint32_t>& indices = m_IndexStorage;
+
+    MeshOptimizeStats stats;
+    stats.Before = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+    std::vector<uint32_t> clusters;
+    OptimizeVertexCache(indices.data(), indices.size(), vertices.size(), DEFAULT_VERTEX_CACHE_SIZE, &clusters);
+    OptimizeOverdraw(indices.data(), indices.size(), vertices.data(), vertices.size(), clusters);
+    OptimizeVertexFetch(vertices, indices.data(), indices.size());
+    stats.After = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+
+    m_Lods.clear();
+    InitStorage();
+    m_Optimized = true;
+    return stats;
+}
+
+void Mesh::GenerateLods(const int maxLodCount, const float reduction)
+{
+    ASSERT(!IsMapped(), "映射的网格不能生成细节层级");
+    ASSERT(reduction > 0.0f && reduction < 1.0f);
+    ASSERT(m_MeshletStorage.empty(), "须在划分网格簇之前生成细节层级");
+    std::vector<BlinnVertex>& vertices = m_VertexStorage;
+
+    /* 每一级由上一级简化得到, 误差逐级累加, 是相对原始网格误差的上界 */
+    const MeshLod& base = m_Lods[0];
+    std::vector<uint32_t> indices(m_IndexStorage.begin() + base.IndexOffset, m_IndexStorage.begin() + base.IndexOffset + base.IndexCount);
+    std::vector<MeshLod> lods = { { 0, base.IndexCount, 0, 0, 0, 0.0f } };
+    std::vector<uint32_t> source = indices;
+    std::vector<uint32_t> simplified;
+    float error = 0.0f;
+    while ((int)lods.size() < maxLodCount && source.size() / 3 > MIN_LOD_TRIANGLE_COUNT)
+    {
+        const size_t targetIndexCount = (size_t)((float)(source.size() / 3) * reduction) * 3;
+        float lodError = 0.0f;
+        simplified.resize(source.size());
+        size_t indexCount = SimplifyMesh(simplified.data(), source.data(), source.size(), vertices.data(), vertices.size(),
+                                        targetIndexCount, FLT_MAX, &lodError);
+        if (indexCount > source.size() * 95 / 100)
+            break;      // 剩余的顶点大多被锁定, 无法继续简化
+        simplified.resize(indexCount);
+        OptimizeVertexCache(simplified.data(), indexCount, vertices.size());
+
+        error += lodError;
+        lods.push_back({ (uint32_t)indices.size(), (uint32_t)indexCount, 0, 0, 0, error });
+        indices.insert(indices.end(), simplified.begin(), simplified.end());
+        source.swap(simplified);
+    }
+
+    /* 从最粗糙的层级开始按首次使用重排顶点: 较粗糙层级的顶点是较精细层级顶点的子集, 因此每个层级引用的顶点都是顶点缓冲的前缀 */
+    std::vector<uint32_t> ordered;
+    ordered.reserve(indices.size());
+    for (auto lod = lods.rbegin(); lod != lods.rend(); ++lod)
+        ordered.insert(ordered.end(), indices.begin() + lod->IndexOffset, indices.begin() + lod->IndexOffset + lod->IndexCount);
+    OptimizeVertexFetch(vertices, ordered.data(), ordered.size());
+    size_t offset = 0;
+    for (auto lod = lods.rbegin(); lod != lods.rend(); ++lod)
+    {
+        uint32_t vertexCount = 0;
+        for (uint32_t i = 0; i < lod->IndexCount; i++)
+        {
+            indices[lod->IndexOffset + i] = ordered[offset + i];
+            vertexCount = std::max(vertexCount, ordered[offset + i] + 1);
+        }
+        lod->VertexCount = vertexCount;
+        offset += lod->IndexCount;
+    }
+
+    m_IndexStorage.swap(indices);
+    m_Lods.swap(lods);
+    m_LodsGenerated = true;
+    InitStorage();
+}
+
+void Mesh::BuildMeshlets()
+{
+    ASSERT(!IsMapped(), "映射的网格不能划分网格簇");
+    std::vector<Meshlet> meshlets;
+    for (MeshLod& lod : m_Lods)
+    {
+        lod.MeshletOffset = (uint32_t)meshlets.size();
+        lod.MeshletCount = (uint32_t)RGS::BuildMeshlets(meshlets, m_IndexStorage.data(), lod.IndexOffset, lod.IndexCount,
+                                                        &m_VertexStorage[0].ModelPos.X, sizeof(BlinnVertex), m_VertexStorage.size());
+    }
+    m_MeshletStorage.swap(meshlets);
+    InitStorage();
+}
+
+int Mesh::SelectLod(const float distance, const float projScale, const float maxPixelError, const float modelScale) const
+{
+    // 几何误差按透视投影到屏幕: 像素误差 = 误差 * projScale / 距离
+    if (distance <= 0.0f)
+        return 0;
+    const float maxError = maxPixelError * distance / (projScale * modelScale);
+    int lod = 0;
+    for (int i = 1; i < (int)m_Lods.size() && m_Lods[i].Error <= maxError; i++)
+        lod = i;
+    return lod;
+}
+
+void Mesh::InitStorage()
+{
+    m_Vertices = m_VertexStorage.data();
+    m_VertexCount = m_VertexStorage.size();
+    m_Indices = m_IndexStorage.data();
+    m_IndexCount = m_IndexStorage.size();
+    m_Meshlets = m_MeshletStorage.data();
+    m_MeshletCount = m_MeshletStorage.size();
+    if (m_Lods.empty())
+        m_Lods = { { 0, (uint32_t)m_IndexCount, (uint32_t)m_VertexCount, 0, 0, 0.0f } };
+
+    m_BoundsMin = m_BoundsMax = { 0.0f, 0.0f, 0.0f };
+    if (m_VertexCount > 0)
+    {
+        m_BoundsMin = m_BoundsMax = m_Vertices[0].ModelPos;
+        for (size_t i = 1; i < m_VertexCount; i++)
+        {
+            const Vec4& pos = m_Vertices[i].ModelPos;
+            m_BoundsMin = { std::min(m_BoundsMin.X, pos.X), std::min(m_BoundsMin.Y, pos.Y), std::min(m_BoundsMin.Z, pos.Z) };
+            m_BoundsMax = { std::max(m_BoundsMax.X, pos.X), std::max(m_BoundsMax.Y, pos.Y), std::max(m_BoundsMax.Z, pos.Z) };
+        }
+    }
+}
+
+bool Mesh::InitCooked(const std::string& path, const std::string& sourcePath)
+{
+    std::unique_ptr<MappedFile> file = std::make_unique<MappedFile>(path);
+    if (!file->IsValid() || file->GetSize() < sizeof(CookedMeshHeader))
+        return false;
+    const uint8_t* data = file->GetData();
+    const size_t fileSize = file->GetSize();
+
+    CookedMeshHeader header;
+    memcpy(&header, data, sizeof(CookedMeshHeader));
+    if (memcmp(header.Magic, COOKED_MAGIC, sizeof(COOKED_MAGIC)) != 0 || header.Version != COOKED_VERSION
+        || header.VertexSize != sizeof(BlinnVertex) || header.LodCount == 0)
+        return false;
+    if (!sourcePath.empty() && ((m_Options.Optimize && !(header.Flags & COOKED_FLAG_OPTIMIZED))
+        || (m_Options.GenerateLods && !(header.Flags & COOKED_FLAG_LODS))
+        || (m_Options.BuildMeshlets && !(header.Flags & COOKED_FLAG_MESHLETS))))
+        return false;
+    if (sizeof(CookedMeshHeader) + header.LodCount * sizeof(MeshLod) > header.VertexOffset
+        || header.VertexOffset + header.VertexCount * sizeof(BlinnVertex) > header.IndexOffset
+        || header.IndexOffset + header.IndexCount * sizeof(uint32_t) > header.MeshletOffset
+        || header.MeshletOffset + header.MeshletCount * sizeof(Meshlet) > fileSize)
+        return false;
+
+    /* 源文件大小与修改时间一致时认为未改变; 仅修改时间不同时比较内容哈希 */
+    if (!sourcePath.empty())
+    {
+        SourceInfo source;
+        if (!GetSourceInfo(sourcePath, source) || source.Size != header.SourceSize)
+            return false;
+        if (source.Time != header.SourceTime)
+        {
+            if (HashFile(sourcePath) != header.SourceHash)
+                return false;
+            // 内容未改变: 写回新的修改时间, 之后的加载不必再计算哈希; 映射是只读的, 先解除映射再写入
+            file.reset();
+            WriteSourceTime(path, source.Time);
+            file = std::make_unique<MappedFile>(path);
+            if (!file->IsValid() || file->GetSize() != fileSize)
+                return false;
+            data = file->GetData();
+        }
+    }
+
+    std::vector<MeshLod> lods(header.LodCount);
+    memcpy(lods.data(), data + sizeof(CookedMeshHeader), header.LodCount * sizeof(MeshLod));
+    for (const MeshLod& lod : lods)
+    {
+        if ((uint64_t)lod.IndexOffset + lod.IndexCount > header.IndexCount || lod.VertexCount > header.VertexCount
+            || (uint64_t)lod.MeshletOffset + lod.MeshletCount > header.MeshletCount)
+            return false;
+    }
+
+    // 顶点、索引与网格簇直接指向映射的文件内容
+    m_Lods.swap(lods);
+    m_Vertices = (const BlinnVertex*)(data + header.VertexOffset);
+    m_VertexCount = (size_t)header.VertexCount;
+    m_Indices = (const uint32_t*)(data + header.IndexOffset);
+    m_IndexCount = (size_t)header.IndexCount;
+    m_Meshlets = (const Meshlet*)(data + header.MeshletOffset);
+    m_MeshletCount = (size_t)header.MeshletCount;
+    m_BoundsMin = { header.BoundsMin[0], header.BoundsMin[1], header.BoundsMin[2] };
+    m_BoundsMax = { header.BoundsMax[0], header.BoundsMax[1], header.BoundsMax[2] };
+    m_Optimized = (header.Flags & COOKED_FLAG_OPTIMIZED) != 0;
+    m_LodsGenerated = (header.Flags & COOKED_FLAG_LODS) != 0;
+    m_File = std::move(file);
+    return true;
+}
+
+bool Mesh::SaveCooked(const std::string& path, const std::string& sourcePath) const
+{
+    CookedMeshHeader header = {};
+    memcpy(header.Magic, COOKED_MAGIC, sizeof(COOKED_MAGIC));
+    header.Version = COOKED_VERSION;
+    header.VertexSize = sizeof(BlinnVertex);
+    header.LodCount = (uint32_t)m_Lods.size();
+    header.Flags = (m_Optimized ? COOKED_FLAG_OPTIMIZED : 0) | (m_LodsGenerated ? COOKED_FLAG_LODS : 0)
+        | (m_MeshletCount > 0 ? COOKED_FLAG_MESHLETS : 0);
+    header.VertexCount = m_VertexCount;
+    header.IndexCount = m_IndexCount;
+    header.MeshletCount = m_MeshletCount;
+    header.VertexOffset = AlignOffset(sizeof(CookedMeshHeader) + m_Lods.size() * sizeof(MeshLod));
+    header.IndexOffset = AlignOffset(header.VertexOffset + m_VertexCount * sizeof(BlinnVertex));
+    header.MeshletOffset = AlignOffset(header.IndexOffset + m_IndexCount * sizeof(uint32_t));
+    memcpy(header.BoundsMin, &m_BoundsMin.X, sizeof(header.BoundsMin));
+    memcpy(header.BoundsMax, &m_BoundsMax.X, sizeof(header.BoundsMax));
+    if (!sourcePath.empty())
+    {
+        SourceInfo source;
+        if (!GetSourceInfo(sourcePath, source))
+            return false;
+        header.SourceSize = source.Size;
+        header.SourceTime = source.Time;
+        header.SourceHash = HashFile(sourcePath);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    const char padding[COOKED_ALIGNMENT] = {};
+    uint64_t offset = sizeof(CookedMeshHeader) + m_Lods.size() * sizeof(MeshLod);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)m_Lods.data(), (std::streamsize)(m_Lods.size() * sizeof(MeshLod)));
+    file.write(padding, (std::streamsize)(header.VertexOffset - offset));
+    file.write((const char*)m_Vertices, (std::streamsize)(m_VertexCount * sizeof(BlinnVertex)));
+    offset = header.VertexOffset + m_VertexCount * sizeof(BlinnVertex);
+    file.write(padding, (std::streamsize)(header.IndexOffset - offset));
+    file.write((const char*)m_Indices, (std::streamsize)(m_IndexCount * sizeof(uint32_t)));
+    offset = header.IndexOffset + m_IndexCount * sizeof(uint32_t);
+    file.write(padding, (std::streamsize)(header.MeshletOffset - offset));
+    file.write((const char*)m_Meshlets, (std::streamsize)(m_MeshletCount * sizeof(Meshlet)));
+    return (bool)file;
+}
+
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "RGS/Maths.h"
+#include "RGS/MeshOptimizer.h"
+#include "RGS/Meshlet.h"
+#include "RGS/Shaders/BlinnShader.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace RGS {
+
+class MappedFile;
+
+// 细节层级: 索引缓冲中的一段
+struct MeshLod
+{
+    uint32_t IndexOffset;       // 该层级第一个索引的位置
+    uint32_t IndexCount;
+    uint32_t VertexCount;       // 该层级只引用顶点缓冲的前 VertexCount 个顶点
+    uint32_t MeshletOffset;     // 该层级的网格簇, 未生成网格簇时数目为 0
+    uint32_t MeshletCount;
+    float Error;                // 相对原始网格的几何误差(模型空间长度), 原始网格为 0
+};
+
+struct MeshOptions
+{
+    bool Optimize = false;      // 加载 OBJ 后执行网格优化(见 Mesh::Optimize), 结果写入缓存
+    bool GenerateLods = false;  // 加载 OBJ 后生成细节层级(见 Mesh::GenerateLods), 结果写入缓存
+    bool BuildMeshlets = false; // 为每个细节层级划分网格簇(见 Mesh::BuildMeshlets), 结果写入缓存
+    bool UseCache = true;       // 是否读写 OBJ 旁的 .rgsmesh 缓存
+};
+
+// 网格优化前后的顶点缓存统计
+struct MeshOptimizeStats
+{
+    VertexCacheStats Before;
+    VertexCacheStats After;
+};
+
+// 索引网格: 去重后的顶点缓冲与三角形索引缓冲
+// 从 OBJ 加载后自动写入同目录下的 .rgsmesh 缓存, 之后源文件未改变时直接映射缓存使用, 不再解析与拷贝
+class Mesh
+{
+public:
+    /**
+     * @brief 加载网格, 扩展名为 .rgsmesh 时直接映射该文件
+     * @param path OBJ 或 .rgsmesh 文件路径
+     * @param options 加载参数, 缓存中的网格未经优化而需要优化时重新加载 OBJ
+    */
+    Mesh(const std::string& path, const MeshOptions& options = {});
+    Mesh(std::vector<BlinnVertex> vertices, std::vector<uint32_t> indices);
+    ~Mesh();
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    const BlinnVertex* GetVertices() const { return m_Vertices; }
+    size_t GetVertexCount() const { return m_VertexCount; }
+    const uint32_t* GetIndices() const { return m_Indices; }        // 每 3 个索引为一个三角形, 包含所有细节层级
+    size_t GetIndexCount() const { return m_IndexCount; }
+    size_t GetTriangleCount() const { return m_Lods[0].IndexCount / 3; }     // 原始网格的三角形数目
+    const std::vector<MeshLod>& GetLods() const { return m_Lods; }          // 第 0 级为原始网格, 之后逐级变粗糙
+    const Meshlet* GetMeshlets() const { return m_Meshlets; }               // 各层级的网格簇, 见 MeshLod::MeshletOffset
+    size_t GetMeshletCount() const { return m_MeshletCount; }
+    const Vec3& GetBoundsMin() const { return m_BoundsMin; }                // 模型空间包围盒
+    const Vec3& GetBoundsMax() const { return m_BoundsMax; }
+    size_t GetMemorySize() const { return m_VertexCount * sizeof(BlinnVertex) + m_IndexCount * sizeof(uint32_t) + m_MeshletCount * sizeof(Meshlet); }
+    bool IsMapped() const { return m_File != nullptr; }     // 顶点与索引是否直接来自映射的缓存文件
+    bool IsOptimized() const { return m_Optimized; }
+    bool HasGeneratedLods() const { return m_LodsGenerated; }
+    bool HasMeshlets() const { return m_MeshletCount > 0; }
+
+    /**
+     * @brief 网格优化: 按顶点缓存重排三角形(Tipsify), 再按簇重排以减少重复着色, 最后按首次使用顺序重排顶点缓冲
+     *        不能用于映射的网格
+     * @return 优化前后的顶点缓存统计
+    */
+    MeshOptimizeStats Optimize();
+    /**
+     * @brief 用 QEM 简化逐级生成细节层级, 各层级共用顶点缓冲; 顶点缓冲重排为粗糙层级的顶点在前, 使每个层级只引用顶点缓冲的前缀
+     *        不能用于映射的网格, 已有的细节层级会被替换
+     * @param maxLodCount 最多的层级数(含原始网格)
+     * @param reduction 每一级相对上一级保留的三角形比例
+    */
+    void GenerateLods(const int maxLodCount = MAX_LOD_COUNT, const float reduction = 0.5f);
+    /**
+     * @brief 为每个细节层级按索引顺序划分网格簇(见 RGS::BuildMeshlets), 用于绘制时整簇剔除
+     *        须在优化与生成细节层级之后调用, 不能用于映射的网格
+    */
+    void BuildMeshlets();
+    /**
+     * @brief 按屏幕空间误差选择细节层级: 投影到屏幕的几何误差不超过 maxPixelError 的最粗糙层级
+     * @param distance 相机到网格(包围球表面)的距离, 需已乘模型缩放
+     * @param projScale 单位距离处单位长度投影到屏幕的像素数, 即 视口高度 / (2 tan(fovy / 2))
+     * @param maxPixelError 允许的屏幕空间误差(像素)
+     * @param modelScale 模型矩阵的最大缩放, 模型空间误差乘以该值得到世界空间误差
+    */
+    int SelectLod(const float distance, const float projScale, const float maxPixelError, const float modelScale = 1.0f) const;
+
+    /**
+     * @brief 将网格按内存中的布局写入 .rgsmesh 文件
+     * @param sourcePath 源 OBJ 文件, 其大小、修改时间与内容哈希写入文件头用于判断缓存是否过期, 为空时不记录
+     * @return 是否写入成功
+    */
+    bool SaveCooked(const std::string& path, const std::string& sourcePath = "") const;
+
+    static constexpr const char* COOKED_EXTENSION = ".rgsmesh";
+    static constexpr int MAX_LOD_COUNT = 8;
+    static constexpr size_t MIN_LOD_TRIANGLE_COUNT = 32;       // 三角形少于该数目时不再生成更粗糙的层级
+
+private:
+    void Init();
+    void InitObj();     // 加载 OBJ 网格(见 ParseObj), 位置/纹理坐标/法线索引都相同的顶点只保留一份
+    /**
+     * @brief 映射 .rgsmesh 文件
+     * @param sourcePath 非空时检查缓存是否与源文件一致
+     * @return 文件无效或已过期时返回 false
+    */
+    bool InitCooked(const std::string& path, const std::string& sourcePath);
+    void InitStorage();     // 指向自有的顶点、索引与网格簇缓冲, 计算包围盒
+
+private:
+    std::string m_Path;
+    MeshOptions m_Options;
+    bool m_Optimized = false;
+    bool m_LodsGenerated = false;
+    const BlinnVertex* m_Vertices = nullptr;
+    size_t m_VertexCount = 0;
+    const uint32_t* m_Indices = nullptr;
+    size_t m_IndexCount = 0;
+    std::vector<MeshLod> m_Lods;
+    const Meshlet* m_Meshlets = nullptr;
+    size_t m_MeshletCount = 0;
+    Vec3 m_BoundsMin { 0.0f, 0.0f, 0.0f };
+    Vec3 m_BoundsMax { 0.0f, 0.0f, 0.0f };
+
+    std::vector<BlinnVertex> m_VertexStorage;       // 非映射时持有的数据
+    std::vector<uint32_t> m_IndexStorage;
+    std::vector<Meshlet> m_MeshletStorage;
+    std::unique_ptr<MappedFile> m_File;
+};
+
+}
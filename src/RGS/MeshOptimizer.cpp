@@ -0,0 +1,288 @@
+#include "Base.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace RGS {
+
+namespace {
+
+constexpr uint32_t INVALID_INDEX = ~0u;
+
+/**
+ * @brief 用时间戳模拟 FIFO 顶点缓存: 顶点写入缓存时记录当前时间并使时间加一, 之后再写入 cacheSize 个顶点时被挤出
+*/
+class VertexCacheSimulator
+{
+public:
+    VertexCacheSimulator(const size_t vertexCount, const int cacheSize)
+        : m_CacheTimes(vertexCount, 0), m_CacheSize((uint32_t)cacheSize), m_Time((uint32_t)cacheSize + 1) {}
+
+    /**
+     * @brief 访问一个顶点
+     * @return 未命中时返回 true
+    */
+    bool Access(const uint32_t vertex)
+    {
+        if (m_Time - m_CacheTimes[vertex] <= m_CacheSize)
+            return false;
+        m_CacheTimes[vertex] = m_Time++;
+        return true;
+    }
+
+    int AccessTriangle(const uint32_t* triangle)
+    {
+        return (int)Access(triangle[0]) + (int)Access(triangle[1]) + (int)Access(triangle[2]);
+    }
+
+    void Reset() { m_Time += m_CacheSize + 1; }     // 所有顶点都已被挤出
+
+private:
+    std::vector<uint32_t> m_CacheTimes;
+    uint32_t m_CacheSize;
+    uint32_t m_Time;
+};
+
+}
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, const size_t indexCount, const size_t vertexCount, const int cacheSize)
+{
+    VertexCacheStats stats;
+    if (indexCount < 3)
+        return stats;
+
+    VertexCacheSimulator cache(vertexCount, cacheSize);
+    std::vector<uint8_t> used(vertexCount, 0);
+    size_t misses = 0;
+    size_t usedCount = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        ASSERT(indices[i] < vertexCount);
+        misses += cache.Access(indices[i]);
+        usedCount += used[indices[i]] == 0;
+        used[indices[i]] = 1;
+    }
+
+    // 只统计被引用的顶点, 使共用顶点缓冲的细节层级也能得到有意义的 ATVR
+    stats.ACMR = (float)misses / (float)(indexCount / 3);
+    stats.ATVR = (float)misses / (float)usedCount;
+    return stats;
+}
+
+void OptimizeVertexCache(uint32_t* indices, const size_t indexCount, const size_t vertexCount, const int cacheSize, std::vector<uint32_t>* clusters)
+{
+    ASSERT(indexCount % 3 == 0);
+    const size_t triangleCount = indexCount / 3;
+    if (clusters)
+        clusters->clear();
+
+    /* 顶点 -> 相邻三角形的邻接表, liveCounts 为尚未输出的相邻三角形数 */
+    std::vector<uint32_t> liveCounts(vertexCount, 0);
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        ASSERT(indices[i] < vertexCount);
+        liveCounts[indices[i]]++;
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    std::partial_sum(liveCounts.begin(), liveCounts.end(), offsets.begin() + 1);
+    std::vector<uint32_t> adjacency(indexCount);
+    {
+        std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indexCount; i++)
+            adjacency[cursors[indices[i]]++] = (uint32_t)(i / 3);
+    }
+
+    std::vector<uint32_t> cacheTimes(vertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnds;         // 最近输出的顶点, 无法继续展开时从中回溯
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    deadEnds.reserve(indexCount);
+    result.reserve(indexCount);
+    uint32_t time = (uint32_t)cacheSize + 1;
+    size_t cursor = 0;
+
+    // 回溯最近输出且仍有未输出三角形的顶点, 没有时按顺序查找
+    auto skipDeadEnd = [&]() -> uint32_t
+        {
+            while (!deadEnds.empty())
+            {
+                uint32_t vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveCounts[vertex] > 0)
+                    return vertex;
+            }
+            for (; cursor < vertexCount; cursor++)
+            {
+                if (liveCounts[cursor] > 0)
+                    return (uint32_t)cursor;
+            }
+            return INVALID_INDEX;
+        };
+
+    uint32_t fanning = skipDeadEnd();
+    if (clusters && fanning != INVALID_INDEX)
+        clusters->push_back(0);
+    while (fanning != INVALID_INDEX)
+    {
+        /* 输出围绕当前顶点的所有三角形 */
+        candidates.clear();
+        for (uint32_t i = offsets[fanning]; i < offsets[fanning + 1]; i++)
+        {
+            const uint32_t triangle = adjacency[i];
+            if (emitted[triangle])
+                continue;
+            emitted[triangle] = 1;
+            for (int j = 0; j < 3; j++)
+            {
+                const uint32_t vertex = indices[triangle * 3 + j];
+                result.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveCounts[vertex]--;
+                if (time - cacheTimes[vertex] > (uint32_t)cacheSize)
+                    cacheTimes[vertex] = time++;
+            }
+        }
+
+        /* 选择下一个展开的顶点: 展开其剩余三角形后仍留在缓存中的顶点里, 在缓存中最久的优先 */
+        uint32_t next = INVALID_INDEX;
+        int bestPriority = -1;
+        for (const uint32_t vertex : candidates)
+        {
+            if (liveCounts[vertex] == 0)
+                continue;
+            int priority = 0;
+            const uint32_t age = time - cacheTimes[vertex];
+            if (age + 2 * liveCounts[vertex] <= (uint32_t)cacheSize)
+                priority = (int)age;
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = vertex;
+            }
+        }
+        if (next == INVALID_INDEX)
+        {
+            next = skipDeadEnd();
+            if (clusters && next != INVALID_INDEX)
+                clusters->push_back((uint32_t)(result.size() / 3));
+        }
+        fanning = next;
+    }
+
+    ASSERT(result.size() == indexCount);
+    std::copy(result.begin(), result.end(), indices);
+}
+
+void OptimizeOverdraw(uint32_t* indices, const size_t indexCount, const BlinnVertex* vertices, const size_t vertexCount,
+                    const std::vector<uint32_t>& clusters, const float threshold, const int cacheSize)
+{
+    ASSERT(indexCount % 3 == 0);
+    const uint32_t triangleCount = (uint32_t)(indexCount / 3);
+    if (triangleCount == 0 || clusters.empty())
+        return;
+
+    /* 在 Tipsify 的簇内继续切分: 子簇的 ACMR 不超过整簇 ACMR 的 threshold 倍时即可断开 */
+    std::vector<uint32_t> splits;
+    VertexCacheSimulator cache(vertexCount, cacheSize);
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        const uint32_t begin = clusters[c];
+        const uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        ASSERT(begin < end && end <= triangleCount);
+
+        cache.Reset();
+        int clusterMisses = 0;
+        for (uint32_t t = begin; t < end; t++)
+            clusterMisses += cache.AccessTriangle(indices + t * 3);
+        const float maxACMR = threshold * (float)clusterMisses / (float)(end - begin);
+
+        cache.Reset();
+        splits.push_back(begin);
+        uint32_t start = begin;
+        int misses = 0;
+        for (uint32_t t = begin; t + 1 < end; t++)
+        {
+            misses += cache.AccessTriangle(indices + t * 3);
+            if ((float)misses / (float)(t + 1 - start) <= maxACMR)
+            {
+                splits.push_back(t + 1);
+                start = t + 1;
+                misses = 0;
+                cache.Reset();
+            }
+        }
+    }
+    splits.push_back(triangleCount);
+
+    /* 计算各簇与整个网格的面积加权中心, 以及各簇的面积加权法线 */
+    const size_t clusterCount = splits.size() - 1;
+    std::vector<Vec3> centroids(clusterCount, { 0.0f, 0.0f, 0.0f });
+    std::vector<Vec3> normals(clusterCount, { 0.0f, 0.0f, 0.0f });
+    std::vector<float> areas(clusterCount, 0.0f);
+    Vec3 meshCentroid { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; c++)
+    {
+        for (uint32_t t = splits[c]; t < splits[c + 1]; t++)
+        {
+            const uint32_t* triangle = indices + t * 3;
+            Vec3 p0 = vertices[triangle[0]].ModelPos;
+            Vec3 p1 = vertices[triangle[1]].ModelPos;
+            Vec3 p2 = vertices[triangle[2]].ModelPos;
+            Vec3 normal = Cross(p1 - p0, p2 - p0);      // 长度为面积的两倍
+            float area = (float)std::sqrt(Dot(normal, normal));
+            centroids[c] = centroids[c] + (p0 + p1 + p2) * (area / 3.0f);
+            normals[c] = normals[c] + normal;
+            areas[c] += area;
+        }
+        meshCentroid = meshCentroid + centroids[c];
+        meshArea += areas[c];
+    }
+    if (meshArea > 0.0f)
+        meshCentroid = meshCentroid / meshArea;
+
+    /* 朝外程度: 簇中心相对网格中心的偏移在簇法线上的投影, 越大越先绘制 */
+    std::vector<float> sortKeys(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; c++)
+    {
+        if (areas[c] <= 0.0f)
+            continue;
+        float normalLength = (float)std::sqrt(Dot(normals[c], normals[c]));
+        if (normalLength > 0.0f)
+            sortKeys[c] = Dot(centroids[c] / areas[c] - meshCentroid, normals[c] / normalLength);
+    }
+    std::vector<uint32_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indexCount);
+    for (const uint32_t c : order)
+        result.insert(result.end(), indices + splits[c] * 3, indices + splits[c + 1] * 3);
+    std::copy(result.begin(), result.end(), indices);
+}
+
+void OptimizeVertexFetch(std::vector<BlinnVertex>& vertices, uint32_t* indices, const size_t indexCount)
+{
+    std::vector<uint32_t> remap(vertices.size(), INVALID_INDEX);
+    std::vector<BlinnVertex> result;
+    result.reserve(vertices.size());
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        uint32_t& vertex = remap[indices[i]];
+        if (vertex == INVALID_INDEX)
+        {
+            vertex = (uint32_t)result.size();
+            result.push_back(vertices[indices[i]]);
+        }
+        indices[i] = vertex;
+    }
+    vertices.swap(result);
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "RGS/Shaders/BlinnShader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RGS {
+
+// 模拟 FIFO 顶点缓存(变换后缓存)得到的统计
+struct VertexCacheStats
+{
+    float ACMR = 0.0f;      // 平均每个三角形的缓存未命中数, 理想值约 0.5, 最差为 3
+    float ATVR = 0.0f;      // 平均每个顶点的着色次数(未命中数 / 顶点数), 理想值为 1
+};
+
+constexpr int DEFAULT_VERTEX_CACHE_SIZE = 16;
+
+/**
+ * @brief 按给定容量的 FIFO 顶点缓存统计索引缓冲的未命中情况
+ * @param indices 索引缓冲, 每 3 个索引为一个三角形
+ * @param vertexCount 顶点数目
+*/
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, const size_t indexCount, const size_t vertexCount,
+                                    const int cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+/**
+ * @brief 使用 Tipsify 算法重排三角形, 使共享顶点的三角形相邻, 提高顶点缓存命中率(线性时间)
+ * @param clusters 可选, 输出各三角形簇的起始三角形编号; 簇在 Tipsify 无法继续围绕已缓存顶点展开时断开, 供 OptimizeOverdraw 使用
+*/
+void OptimizeVertexCache(uint32_t* indices, const size_t indexCount, const size_t vertexCount,
+                        const int cacheSize = DEFAULT_VERTEX_CACHE_SIZE, std::vector<uint32_t>* clusters = nullptr);
+
+/**
+ * @brief 重排三角形簇以减少常见视角下的重复着色: 朝外且位于外侧的簇先绘制, 使其后被遮挡的片段被提前深度测试剔除
+ *        索引缓冲须已经过 OptimizeVertexCache, 簇内顺序保持不变, 因此顶点缓存命中率最多降低到原来的 1/threshold
+ * @param clusters OptimizeVertexCache 输出的簇起始三角形编号
+ * @param threshold 允许的 ACMR 放大倍数, 越大簇越小、排序越细, 顶点缓存命中率越低
+*/
+void OptimizeOverdraw(uint32_t* indices, const size_t indexCount, const BlinnVertex* vertices, const size_t vertexCount,
+                    const std::vector<uint32_t>& clusters, const float threshold = 1.05f, const int cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+/**
+ * @brief 按顶点在索引缓冲中第一次被使用的顺序重排顶点缓冲, 使顶点读取接近顺序访问; 未被使用的顶点被移除
+*/
+void OptimizeVertexFetch(std::vector<BlinnVertex>& vertices, uint32_t* indices, const size_t indexCount);
+
+}
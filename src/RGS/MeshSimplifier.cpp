@@ -0,0 +1,367 @@
+#include "Base.h"
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace RGS {
+
+namespace {
+
+constexpr float BORDER_WEIGHT = 10.0f;       // 边界约束平面的权重, 使开放边界尽量保持形状
+
+enum class VertexKind : uint8_t
+{
+    MANIFOLD,       // 内部顶点, 可以折叠到任意相邻顶点
+    BORDER,         // 开放边界上的顶点, 只能沿边界折叠到另一个边界顶点
+    LOCKED,         // 接缝或非流形顶点, 不能移动
+};
+
+// 二次误差: 到一组带权平面的距离平方和, E(p) = p^T A p + 2 b·p + c
+struct Quadric
+{
+    float A00 = 0.0f, A11 = 0.0f, A22 = 0.0f;
+    float A10 = 0.0f, A20 = 0.0f, A21 = 0.0f;
+    float B0 = 0.0f, B1 = 0.0f, B2 = 0.0f;
+    float C = 0.0f;
+    float Weight = 0.0f;
+
+    /**
+     * @brief 加入平面 n·p + d = 0, n 为单位向量
+    */
+    void AddPlane(const Vec3& n, const float d, const float weight)
+    {
+        A00 += weight * n.X * n.X;
+        A11 += weight * n.Y * n.Y;
+        A22 += weight * n.Z * n.Z;
+        A10 += weight * n.Y * n.X;
+        A20 += weight * n.Z * n.X;
+        A21 += weight * n.Z * n.Y;
+        B0 += weight * n.X * d;
+        B1 += weight * n.Y * d;
+        B2 += weight * n.Z * d;
+        C += weight * d * d;
+        Weight += weight;
+    }
+
+    void Add(const Quadric& other)
+    {
+        A00 += other.A00; A11 += other.A11; A22 += other.A22;
+        A10 += other.A10; A20 += other.A20; A21 += other.A21;
+        B0 += other.B0; B1 += other.B1; B2 += other.B2;
+        C += other.C;
+        Weight += other.Weight;
+    }
+
+    /**
+     * @brief 按权重归一化的误差, 即到各平面的平均距离平方
+    */
+    float GetError(const Vec3& p) const
+    {
+        float rx = A00 * p.X + A10 * p.Y + A20 * p.Z + B0;
+        float ry = A10 * p.X + A11 * p.Y + A21 * p.Z + B1;
+        float rz = A20 * p.X + A21 * p.Y + A22 * p.Z + B2;
+        float error = rx * p.X + ry * p.Y + rz * p.Z + B0 * p.X + B1 * p.Y + B2 * p.Z + C;
+        return Weight > 0.0f ? std::max(error, 0.0f) / Weight : 0.0f;
+    }
+};
+
+struct Collapse
+{
+    uint32_t From;
+    uint32_t To;
+    float Error;
+};
+
+inline uint64_t GetEdgeKey(const uint32_t a, const uint32_t b)
+{
+    return ((uint64_t)a << 32) | b;
+}
+
+inline Vec3 GetPosition(const BlinnVertex* vertices, const uint32_t index)
+{
+    return vertices[index].ModelPos;
+}
+
+/**
+ * @brief 位置相同的顶点(接缝两侧的顶点)映射到同一个代表顶点
+*/
+std::vector<uint32_t> BuildPositionRemap(const BlinnVertex* vertices, const size_t vertexCount)
+{
+    struct PositionHash
+    {
+        size_t operator()(const Vec3& p) const
+        {
+            uint32_t bits[3];
+            memcpy(bits, &p.X, sizeof(bits));
+            return (size_t)((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u));
+        }
+    };
+    struct PositionEqual
+    {
+        bool operator()(const Vec3& a, const Vec3& b) const { return a.X == b.X && a.Y == b.Y && a.Z == b.Z; }
+    };
+
+    std::vector<uint32_t> remap(vertexCount);
+    std::unordered_map<Vec3, uint32_t, PositionHash, PositionEqual> positions;
+    positions.reserve(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++)
+        remap[i] = positions.emplace(GetPosition(vertices, (uint32_t)i), (uint32_t)i).first->second;
+    return remap;
+}
+
+}
+
+size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, const size_t indexCount,
+                    const BlinnVertex* vertices, const size_t vertexCount,
+                    const size_t targetIndexCount, const float targetError, float* resultError)
+{
+    ASSERT(indexCount % 3 == 0);
+    if (destination != indices)
+        std::copy(indices, indices + indexCount, destination);
+    size_t resultCount = indexCount;
+    float maxError = 0.0f;      // 已执行折叠的最大误差平方
+    if (resultError)
+        *resultError = 0.0f;
+    if (resultCount <= targetIndexCount)
+        return resultCount;
+
+    const std::vector<uint32_t> positionRemap = BuildPositionRemap(vertices, vertexCount);
+
+    /* 按位置统计半边, 没有反向半边的边为开放边界, 同向半边重复的边为非流形边 */
+    std::unordered_map<uint64_t, uint32_t> halfEdges;
+    halfEdges.reserve(indexCount);
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            uint32_t a = positionRemap[destination[i + j]];
+            uint32_t b = positionRemap[destination[i + (j + 1) % 3]];
+            halfEdges[GetEdgeKey(a, b)]++;
+        }
+    }
+    auto isBorderEdge = [&](const uint32_t a, const uint32_t b)
+        {
+            return halfEdges.find(GetEdgeKey(b, a)) == halfEdges.end();
+        };
+
+    /* 顶点分类: 位置上有多个被引用顶点的为接缝, 与非流形边相连或位于多条边界交汇处的为非流形, 均锁定 */
+    std::vector<VertexKind> kinds(vertexCount, VertexKind::MANIFOLD);
+    {
+        std::vector<uint32_t> wedges(vertexCount, ~0u);     // 每个位置第一个被引用的顶点
+        std::vector<uint8_t> seams(vertexCount, 0);
+        std::vector<uint8_t> borderOut(vertexCount, 0);
+        std::vector<uint8_t> borderIn(vertexCount, 0);
+        std::vector<uint8_t> complex(vertexCount, 0);
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            uint32_t vertex = destination[i];
+            uint32_t position = positionRemap[vertex];
+            if (wedges[position] == ~0u)
+                wedges[position] = vertex;
+            else if (wedges[position] != vertex)
+                seams[position] = 1;
+        }
+        for (const auto& [key, count] : halfEdges)
+        {
+            uint32_t a = (uint32_t)(key >> 32);
+            uint32_t b = (uint32_t)key;
+            if (count > 1)
+                complex[a] = complex[b] = 1;
+            if (isBorderEdge(a, b))
+            {
+                borderOut[a] = (uint8_t)std::min(borderOut[a] + 1, 2);
+                borderIn[b] = (uint8_t)std::min(borderIn[b] + 1, 2);
+            }
+        }
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            uint32_t position = positionRemap[i];
+            if (seams[position] || complex[position] || borderOut[position] != borderIn[position] || borderOut[position] > 1)
+                kinds[i] = VertexKind::LOCKED;
+            else if (borderOut[position] == 1)
+                kinds[i] = VertexKind::BORDER;
+        }
+    }
+
+    /* 每个位置的二次误差: 相邻三角形所在平面按面积加权, 开放边界再加入垂直于三角形的约束平面 */
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+        Vec3 p0 = GetPosition(vertices, destination[i]);
+        Vec3 p1 = GetPosition(vertices, destination[i + 1]);
+        Vec3 p2 = GetPosition(vertices, destination[i + 2]);
+        Vec3 normal = Cross(p1 - p0, p2 - p0);
+        float area = (float)std::sqrt(Dot(normal, normal));
+        if (area <= 0.0f)
+            continue;
+        normal = normal / area;
+        Quadric quadric;
+        quadric.AddPlane(normal, -Dot(normal, p0), area * 0.5f);
+        for (int j = 0; j < 3; j++)
+            quadrics[positionRemap[destination[i + j]]].Add(quadric);
+
+        for (int j = 0; j < 3; j++)
+        {
+            uint32_t a = positionRemap[destination[i + j]];
+            uint32_t b = positionRemap[destination[i + (j + 1) % 3]];
+            if (!isBorderEdge(a, b))
+                continue;
+            Vec3 pa = GetPosition(vertices, a);
+            Vec3 edge = GetPosition(vertices, b) - pa;
+            float lengthSquared = Dot(edge, edge);
+            Vec3 edgeNormal = Cross(edge, normal);
+            float length = (float)std::sqrt(Dot(edgeNormal, edgeNormal));
+            if (length <= 0.0f)
+                continue;
+            edgeNormal = edgeNormal / length;
+            Quadric edgeQuadric;
+            edgeQuadric.AddPlane(edgeNormal, -Dot(edgeNormal, pa), lengthSquared * BORDER_WEIGHT);
+            quadrics[a].Add(edgeQuadric);
+            quadrics[b].Add(edgeQuadric);
+        }
+    }
+
+    const float errorLimit = targetError * targetError;
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapseRemap(vertexCount);
+    std::vector<uint8_t> collapseLocked(vertexCount);
+
+    // 当前网格中只有一个三角形包含边 (from, to) 时为边界边; 折叠会产生新的边, 因此按当前的邻接关系判断
+    auto isCurrentBorderEdge = [&](const uint32_t from, const uint32_t to)
+        {
+            int triangleCount = 0;
+            for (uint32_t k = adjacencyOffsets[from]; k < adjacencyOffsets[from + 1]; k++)
+            {
+                const uint32_t* triangle = destination + adjacency[k] * 3;
+                for (int j = 0; j < 3; j++)
+                    triangleCount += positionRemap[triangle[j]] == positionRemap[to];
+            }
+            return triangleCount == 1;
+        };
+
+    auto canCollapse = [&](const uint32_t from, const uint32_t to)
+        {
+            if (kinds[from] == VertexKind::MANIFOLD)
+                return true;
+            if (kinds[from] == VertexKind::BORDER)
+                return kinds[to] != VertexKind::MANIFOLD && isCurrentBorderEdge(from, to);
+            return false;
+        };
+
+    // 折叠后相邻三角形的法线与原来方向相反(或退化)时拒绝
+    auto hasTriangleFlips = [&](const uint32_t from, const uint32_t to)
+        {
+            const Vec3 target = GetPosition(vertices, to);
+            for (uint32_t k = adjacencyOffsets[from]; k < adjacencyOffsets[from + 1]; k++)
+            {
+                const uint32_t* triangle = destination + adjacency[k] * 3;
+                if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+                    continue;       // 该三角形折叠后退化并被移除
+                Vec3 p[3];
+                Vec3 q[3];
+                for (int j = 0; j < 3; j++)
+                {
+                    p[j] = GetPosition(vertices, triangle[j]);
+                    q[j] = triangle[j] == from ? target : p[j];
+                }
+                Vec3 before = Cross(p[1] - p[0], p[2] - p[0]);
+                Vec3 after = Cross(q[1] - q[0], q[2] - q[0]);
+                if (Dot(before, after) <= 0.25f * Dot(before, before))
+                    return true;
+            }
+            return false;
+        };
+
+    while (resultCount > targetIndexCount)
+    {
+        /* 顶点 -> 相邻三角形 */
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (size_t i = 0; i < resultCount; i++)
+            adjacencyOffsets[destination[i] + 1]++;
+        for (size_t i = 0; i < vertexCount; i++)
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+        adjacency.resize(resultCount);
+        {
+            std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < resultCount; i++)
+                adjacency[cursors[destination[i]]++] = (uint32_t)(i / 3);
+        }
+
+        /* 收集每条边误差较小的折叠方向, 按误差排序 */
+        collapses.clear();
+        for (size_t i = 0; i < resultCount; i += 3)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                uint32_t a = destination[i + j];
+                uint32_t b = destination[i + (j + 1) % 3];
+                float errorAB = canCollapse(a, b) ? quadrics[positionRemap[a]].GetError(GetPosition(vertices, b)) : INFINITY;
+                float errorBA = canCollapse(b, a) ? quadrics[positionRemap[b]].GetError(GetPosition(vertices, a)) : INFINITY;
+                if (errorAB == INFINITY && errorBA == INFINITY)
+                    continue;
+                collapses.push_back(errorAB <= errorBA ? Collapse{ a, b, errorAB } : Collapse{ b, a, errorBA });
+            }
+        }
+        if (collapses.empty())
+            break;
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Error < b.Error; });
+
+        /* 依次执行折叠, 同一轮中被折叠顶点的一环邻域不再参与其他折叠, 保证翻转检测使用的位置是最新的 */
+        for (size_t i = 0; i < vertexCount; i++)
+            collapseRemap[i] = (uint32_t)i;
+        std::fill(collapseLocked.begin(), collapseLocked.end(), 0);
+        const size_t triangleGoal = (resultCount - targetIndexCount) / 3;
+        size_t removedTriangles = 0;
+        size_t collapseCount = 0;
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapse.Error > errorLimit || removedTriangles >= triangleGoal)
+                break;
+            if (collapseLocked[collapse.From] || collapseLocked[collapse.To])
+                continue;
+            if (hasTriangleFlips(collapse.From, collapse.To))
+                continue;
+
+            collapseRemap[collapse.From] = collapse.To;
+            quadrics[positionRemap[collapse.To]].Add(quadrics[positionRemap[collapse.From]]);
+            for (uint32_t k = adjacencyOffsets[collapse.From]; k < adjacencyOffsets[collapse.From + 1]; k++)
+            {
+                const uint32_t* triangle = destination + adjacency[k] * 3;
+                collapseLocked[triangle[0]] = collapseLocked[triangle[1]] = collapseLocked[triangle[2]] = 1;
+            }
+            collapseLocked[collapse.To] = 1;
+            removedTriangles += kinds[collapse.From] == VertexKind::BORDER ? 1 : 2;
+            maxError = std::max(maxError, collapse.Error);
+            collapseCount++;
+        }
+        if (collapseCount == 0)
+            break;
+
+        /* 重映射索引并移除退化的三角形 */
+        size_t writeCount = 0;
+        for (size_t i = 0; i < resultCount; i += 3)
+        {
+            uint32_t a = collapseRemap[destination[i]];
+            uint32_t b = collapseRemap[destination[i + 1]];
+            uint32_t c = collapseRemap[destination[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            destination[writeCount++] = a;
+            destination[writeCount++] = b;
+            destination[writeCount++] = c;
+        }
+        resultCount = writeCount;
+    }
+
+    if (resultError)
+        *resultError = (float)std::sqrt(maxError);
+    return resultCount;
+}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "RGS/Shaders/BlinnShader.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace RGS {
+
+/**
+ * @brief 使用二次误差度量(QEM)简化网格: 按误差从小到大反复将边的一端折叠到另一端
+ *        折叠只会把顶点移动到已有顶点上, 简化结果引用的顶点是输入顶点的子集, 因此可以与原网格共用顶点缓冲
+ *        纹理坐标或法线不连续的接缝顶点与非流形顶点保持不动, 开放边界上的顶点只沿边界折叠, 会使三角形翻转的折叠被拒绝
+ * @param destination 输出的索引缓冲, 容量不小于 indexCount, 可以与 indices 相同
+ * @param indices 输入的索引缓冲, 每 3 个索引为一个三角形
+ * @param targetIndexCount 目标索引数, 达到后停止
+ * @param targetError 允许的最大几何误差(模型空间长度), 达到后停止
+ * @param resultError 可选, 输出简化产生的几何误差
+ * @return 输出的索引数
+*/
+size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, const size_t indexCount,
+                    const BlinnVertex* vertices, const size_t vertexCount,
+                    const size_t targetIndexCount, const float targetError, float* resultError = nullptr);
+
+}
@@ -0,0 +1,127 @@
+#include "Base.h"
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace RGS {
+
+namespace {
+
+Vec3 GetPosition(const float* positions, const size_t positionStride, const uint32_t vertex)
+{
+    const float* position = (const float*)((const uint8_t*)positions + vertex * positionStride);
+    return { position[0], position[1], position[2] };
+}
+
+/**
+ * @brief 计算一段三角形的包围球(包围盒中心)与法线锥
+*/
+Meshlet ComputeMeshletBounds(const uint32_t* indices, const uint32_t indexOffset, const uint32_t triangleCount,
+                            const float* positions, const size_t positionStride)
+{
+    Meshlet meshlet;
+    meshlet.IndexOffset = indexOffset;
+    meshlet.TriangleCount = triangleCount;
+    const uint32_t* triangles = indices + indexOffset;
+
+    Vec3 boundsMin { FLT_MAX, FLT_MAX, FLT_MAX };
+    Vec3 boundsMax { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = 0; i < triangleCount * 3; i++)
+    {
+        Vec3 pos = GetPosition(positions, positionStride, triangles[i]);
+        boundsMin = { std::min(boundsMin.X, pos.X), std::min(boundsMin.Y, pos.Y), std::min(boundsMin.Z, pos.Z) };
+        boundsMax = { std::max(boundsMax.X, pos.X), std::max(boundsMax.Y, pos.Y), std::max(boundsMax.Z, pos.Z) };
+    }
+    meshlet.Center = (boundsMin + boundsMax) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (uint32_t i = 0; i < triangleCount * 3; i++)
+    {
+        Vec3 offset = GetPosition(positions, positionStride, triangles[i]) - meshlet.Center;
+        radiusSquared = std::max(radiusSquared, Dot(offset, offset));
+    }
+    meshlet.Radius = (float)std::sqrt(radiusSquared);
+
+    /* 法线锥: 轴为各三角形单位法线的平均方向, 锥角由与轴夹角最大的法线决定 */
+    std::vector<Vec3> normals;
+    normals.reserve(triangleCount);
+    Vec3 axis { 0.0f, 0.0f, 0.0f };
+    for (uint32_t i = 0; i < triangleCount; i++)
+    {
+        Vec3 p0 = GetPosition(positions, positionStride, triangles[i * 3]);
+        Vec3 p1 = GetPosition(positions, positionStride, triangles[i * 3 + 1]);
+        Vec3 p2 = GetPosition(positions, positionStride, triangles[i * 3 + 2]);
+        Vec3 normal = Cross(p1 - p0, p2 - p0);
+        float length = (float)std::sqrt(Dot(normal, normal));
+        if (length <= 0.0f)
+            continue;       // 退化三角形不会被光栅化
+        normals.push_back(normal / length);
+        axis = axis + normals.back();
+    }
+    meshlet.ConeAxis = { 0.0f, 0.0f, 0.0f };
+    meshlet.ConeCutoff = 1.0f;
+    float axisLength = (float)std::sqrt(Dot(axis, axis));
+    if (normals.empty() || axisLength <= 0.0f)
+        return meshlet;
+    axis = axis / axisLength;
+    float minDot = 1.0f;
+    for (const Vec3& normal : normals)
+        minDot = std::min(minDot, Dot(normal, axis));
+    meshlet.ConeAxis = axis;
+    if (minDot > 0.1f)     // 锥角接近或超过 90 度时几乎不可能整簇背向, 不做剔除
+        meshlet.ConeCutoff = (float)std::sqrt(1.0f - minDot * minDot);
+    return meshlet;
+}
+
+}
+
+size_t BuildMeshlets(std::vector<Meshlet>& meshlets, const uint32_t* indices, const size_t indexOffset, const size_t indexCount,
+                    const float* positions, const size_t positionStride, const size_t vertexCount, const size_t maxVertices, const size_t maxTriangles)
+{
+    ASSERT(indexCount % 3 == 0);
+    ASSERT(maxVertices >= 3 && maxTriangles >= 1);
+    const size_t firstMeshlet = meshlets.size();
+
+    // 顶点所属的网格簇编号, 用于统计簇内的不同顶点数
+    std::vector<uint32_t> vertexMeshlets(vertexCount, ~0u);
+    uint32_t meshletId = 0;
+    uint32_t beginIndex = (uint32_t)indexOffset;
+    uint32_t triangleCount = 0;
+    size_t uniqueVertexCount = 0;
+
+    auto countNewVertices = [&](const uint32_t* triangle)
+        {
+            size_t count = 0;
+            for (int j = 0; j < 3; j++)
+            {
+                bool repeated = (j > 0 && triangle[j] == triangle[0]) || (j > 1 && triangle[j] == triangle[1]);
+                count += !repeated && vertexMeshlets[triangle[j]] != meshletId;
+            }
+            return count;
+        };
+
+    for (size_t i = indexOffset; i < indexOffset + indexCount; i += 3)
+    {
+        const uint32_t* triangle = indices + i;
+        size_t newVertexCount = countNewVertices(triangle);
+        if (triangleCount > 0 && (triangleCount + 1 > maxTriangles || uniqueVertexCount + newVertexCount > maxVertices))
+        {
+            meshlets.push_back(ComputeMeshletBounds(indices, beginIndex, triangleCount, positions, positionStride));
+            meshletId++;
+            beginIndex = (uint32_t)i;
+            triangleCount = 0;
+            uniqueVertexCount = 0;
+            newVertexCount = countNewVertices(triangle);
+        }
+        for (int j = 0; j < 3; j++)
+            vertexMeshlets[triangle[j]] = meshletId;
+        uniqueVertexCount += newVertexCount;
+        triangleCount++;
+    }
+    if (triangleCount > 0)
+        meshlets.push_back(ComputeMeshletBounds(indices, beginIndex, triangleCount, positions, positionStride));
+    return meshlets.size() - firstMeshlet;
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "RGS/Maths.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RGS {
+
+// 网格簇: 索引缓冲中连续的一段三角形, 附带用于整簇剔除的包围球与法线锥
+struct Meshlet
+{
+    uint32_t IndexOffset;       // 第一个索引在索引缓冲中的位置
+    uint32_t TriangleCount;
+    Vec3 Center;                // 模型空间包围球
+    float Radius;
+    Vec3 ConeAxis;              // 法线锥: 所有三角形法线与轴的夹角不超过锥角
+    float ConeCutoff;           // 锥角的正弦, 大于等于 1 表示法线过于分散, 不做背面剔除
+};
+
+constexpr size_t MAX_MESHLET_VERTICES = 64;
+constexpr size_t MAX_MESHLET_TRIANGLES = 124;
+
+/**
+ * @brief 按索引顺序将一段三角形划分为网格簇, 簇内的不同顶点数与三角形数不超过上限
+ *        索引缓冲应先经过 OptimizeVertexCache, 使相邻三角形在空间上也相邻
+ * @param meshlets 追加生成的网格簇
+ * @param indexOffset 该段三角形的第一个索引的位置
+ * @param indexCount 该段三角形的索引数
+ * @param positions 第一个顶点的模型空间位置(连续的 3 个 float)
+ * @param positionStride 相邻顶点位置之间的字节数
+ * @return 生成的网格簇数目
+*/
+size_t BuildMeshlets(std::vector<Meshlet>& meshlets, const uint32_t* indices, const size_t indexOffset, const size_t indexCount,
+                    const float* positions, const size_t positionStride, const size_t vertexCount,
+                    const size_t maxVertices = MAX_MESHLET_VERTICES, const size_t maxTriangles = MAX_MESHLET_TRIANGLES);
+
+}
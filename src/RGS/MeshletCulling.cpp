@@ -0,0 +1,62 @@
+#include "MeshletCulling.h"
+
+#include <cfloat>
+#include <cmath>
+
+namespace RGS {
+
+MeshletCulling::MeshletCulling(const Mat4& mvp, const Vec3& cameraPos)
+    : CameraPos(cameraPos)
+{
+    Mat4FrustumPlanes(mvp, FrustumPlanes);
+}
+
+bool IsMeshletVisible(const Meshlet& meshlet, const MeshletCulling& culling)
+{
+    /* 视锥剔除 */
+    for (const Vec4& plane : culling.FrustumPlanes)
+    {
+        if (plane.X * meshlet.Center.X + plane.Y * meshlet.Center.Y + plane.Z * meshlet.Center.Z + plane.W < -meshlet.Radius)
+            return false;
+    }
+
+    /* 法线锥背面剔除: 相机位于所有三角形平面的背面 */
+    if (culling.EnableConeCulling && meshlet.ConeCutoff < 1.0f)
+    {
+        Vec3 toCenter = meshlet.Center - culling.CameraPos;
+        float distance = (float)std::sqrt(Dot(toCenter, toCenter));
+        if (Dot(toCenter, meshlet.ConeAxis) >= meshlet.ConeCutoff * distance + meshlet.Radius)
+            return false;
+    }
+
+    /* 遮挡剔除: 包围球的外接立方体投影到上一帧屏幕, 最近深度比覆盖区域的最远深度还远 */
+    const DepthPyramid* occlusion = culling.Occlusion;
+    if (occlusion && occlusion->IsValid())
+    {
+        const float width = (float)occlusion->GetWidth();
+        const float height = (float)occlusion->GetHeight();
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+        float minDepth = FLT_MAX;
+        for (int i = 0; i < 8; i++)
+        {
+            Vec4 corner { meshlet.Center.X + ((i & 1) ? meshlet.Radius : -meshlet.Radius),
+                        meshlet.Center.Y + ((i & 2) ? meshlet.Radius : -meshlet.Radius),
+                        meshlet.Center.Z + ((i & 4) ? meshlet.Radius : -meshlet.Radius), 1.0f };
+            Vec4 clipPos = culling.OcclusionMVP * corner;
+            if (clipPos.W <= EPSILON || clipPos.Z < -clipPos.W)
+                return true;        // 与近平面相交, 无法判断
+            float x = (clipPos.X / clipPos.W + 1.0f) * 0.5f * width;
+            float y = (clipPos.Y / clipPos.W + 1.0f) * 0.5f * height;
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+            minDepth = std::min(minDepth, (clipPos.Z / clipPos.W + 1.0f) * 0.5f);
+        }
+        if (occlusion->IsOccluded(minX, minY, maxX, maxY, minDepth))
+            return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "RGS/DepthPyramid.h"
+#include "RGS/Maths.h"
+#include "RGS/Meshlet.h"
+
+namespace RGS {
+
+// 网格簇剔除参数, 位置与平面均在模型空间中
+struct MeshletCulling
+{
+    Vec4 FrustumPlanes[6];                  // 视锥平面 (法线, 距离), 法线指向视锥内部且已归一化
+    Vec3 CameraPos;                         // 模型空间中的相机位置
+    bool EnableConeCulling = true;          // 是否整簇背面剔除, 绘制双面渲染的程序时自动关闭
+    const DepthPyramid* Occlusion = nullptr;    // 上一帧的深度金字塔, 为空时不做遮挡剔除
+    Mat4 OcclusionMVP;                      // 上一帧的模型观察投影矩阵
+
+    MeshletCulling() = default;
+    /**
+     * @param mvp 模型观察投影矩阵, 用于提取视锥平面
+     * @param cameraPos 模型空间中的相机位置
+    */
+    MeshletCulling(const Mat4& mvp, const Vec3& cameraPos);
+};
+
+/**
+ * @brief 整簇剔除: 包围球在视锥外, 法线锥表明所有三角形都背向相机, 或包围盒在上一帧深度中被完全遮挡时返回 false
+ *        上一帧深度只在相机与物体移动较小时有效, 快速运动时被遮挡区域可能晚一帧出现
+*/
+bool IsMeshletVisible(const Meshlet& meshlet, const MeshletCulling& culling);
+
+}
@@ -0,0 +1,378 @@
+#include "Base.h"
+#include "MappedFile.h"
+#include "ObjParser.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace RGS {
+
+namespace {
+
+constexpr size_t MIN_CHUNK_SIZE = 1 << 20;      // 并行解析时每块的最小字节数
+
+inline bool IsSpace(const char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool IsDigit(const char c) { return (unsigned)(c - '0') < 10u; }
+
+inline const char* SkipSpaces(const char* p, const char* end)
+{
+    while (p < end && IsSpace(*p))
+        ++p;
+    return p;
+}
+
+inline const char* SkipLine(const char* p, const char* end)
+{
+    while (p < end && *p != '\n')
+        ++p;
+    return p < end ? p + 1 : end;
+}
+
+/**
+ * @brief 解析十进制浮点数(可带符号、小数与指数), 不依赖区域设置
+ * @return 解析结束的位置, 不是数字时返回 nullptr
+*/
+const char* ParseFloat(const char* p, const char* end, float& value)
+{
+    // 10 的 0 ~ 22 次幂可以用 double 精确表示, 一次乘除即得到正确舍入的结果
+    static constexpr double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int significantDigits = 0;     // 最多保留 19 位有效数字, 不会溢出 uint64_t
+    bool hasDigits = false;
+    for (; p < end && IsDigit(*p); ++p)
+    {
+        hasDigits = true;
+        if (significantDigits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            significantDigits += mantissa != 0;
+        }
+        else
+            exponent++;
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && IsDigit(*p); ++p)
+        {
+            hasDigits = true;
+            if (significantDigits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                significantDigits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+    if (!hasDigits)
+        return nullptr;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* q = p + 1;
+        bool negativeExponent = false;
+        if (q < end && (*q == '-' || *q == '+'))
+        {
+            negativeExponent = *q == '-';
+            ++q;
+        }
+        if (q < end && IsDigit(*q))
+        {
+            int e = 0;
+            for (; q < end && IsDigit(*q); ++q)
+                e = std::min(e * 10 + (*q - '0'), 10000);
+            exponent += negativeExponent ? -e : e;
+            p = q;
+        }
+    }
+
+    double result = (double)mantissa;
+    if (exponent < 0)
+        result = -exponent <= 22 ? result / powers[-exponent] : result * std::pow(10.0, exponent);
+    else if (exponent > 0)
+        result = exponent <= 22 ? result * powers[exponent] : result * std::pow(10.0, exponent);
+    value = (float)(negative ? -result : result);
+    return p;
+}
+
+const char* ParseInt(const char* p, const char* end, int& value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p >= end || !IsDigit(*p))
+        return nullptr;
+    int result = 0;
+    for (; p < end && IsDigit(*p); ++p)
+        result = result * 10 + (*p - '0');
+    value = negative ? -result : result;
+    return p;
+}
+
+/**
+ * @brief 解析一行中的若干个浮点数
+ * @tparam REQUIRED 必须出现的分量数, 之后的分量可省略, 省略时为 0
+*/
+template<int N, int REQUIRED = N>
+const char* ParseFloats(const char* p, const char* end, float* values)
+{
+    for (int i = 0; i < N; i++)
+    {
+        const char* q = ParseFloat(SkipSpaces(p, end), end, values[i]);
+        if (!q && i >= REQUIRED)
+        {
+            std::fill(values + i, values + N, 0.0f);
+            break;
+        }
+        ASSERT(q);
+        p = q;
+    }
+    return p;
+}
+
+// 每块的解析结果, 负索引先按块内已解析的数量转换, 合并时再加上之前各块的数量
+struct ObjChunk
+{
+    ObjData Data;
+    std::vector<uint8_t> Relative;      // 与 Data.Indices 一一对应, 标记哪些分量来自负索引(RELATIVE_*)
+    bool HasRelative = false;
+};
+
+enum : uint8_t
+{
+    RELATIVE_POSITION = 1 << 0,
+    RELATIVE_TEXCOORD = 1 << 1,
+    RELATIVE_NORMAL = 1 << 2,
+};
+
+/**
+ * @brief 将 OBJ 索引(从 1 开始, 负数表示从当前末尾倒数)转换为从 0 开始的索引
+ * @param count 当前已解析的该类属性数量
+ * @return 是否为负索引
+*/
+inline bool ResolveIndex(int& index, const size_t count)
+{
+    ASSERT(index != 0);
+    if (index > 0)
+    {
+        index--;
+        return false;
+    }
+    index += (int)count;
+    return true;
+}
+
+/**
+ * @brief 解析面的一个顶点: v, v/vt, v//vn 或 v/vt/vn, 缺失的分量为 -1
+ * @param relative 输出哪些分量来自负索引
+*/
+const char* ParseFaceVertex(const char* p, const char* end, const ObjData& data, ObjIndex& index, uint8_t& relative)
+{
+    index = { 0, -1, -1 };
+    relative = 0;
+    p = ParseInt(p, end, index.Position);
+    ASSERT(p);
+    if (ResolveIndex(index.Position, data.Positions.size()))
+        relative |= RELATIVE_POSITION;
+    if (p < end && *p == '/')
+    {
+        ++p;
+        if (p < end && *p != '/')
+        {
+            p = ParseInt(p, end, index.TexCoord);
+            ASSERT(p);
+            if (ResolveIndex(index.TexCoord, data.TexCoords.size()))
+                relative |= RELATIVE_TEXCOORD;
+        }
+        if (p < end && *p == '/')
+        {
+            p = ParseInt(p + 1, end, index.Normal);
+            ASSERT(p);
+            if (ResolveIndex(index.Normal, data.Normals.size()))
+                relative |= RELATIVE_NORMAL;
+        }
+    }
+    return p;
+}
+
+/**
+ * @brief 解析一个面, 多边形按扇形三角化
+*/
+const char* ParseFace(const char* p, const char* end, ObjChunk& chunk)
+{
+    std::vector<ObjIndex>& indices = chunk.Data.Indices;
+    std::vector<uint8_t>& relatives = chunk.Relative;
+    const size_t first = indices.size();
+    size_t cornerNum = 0;
+    while (true)
+    {
+        p = SkipSpaces(p, end);
+        if (p >= end || *p == '\n' || *p == '#')
+            break;
+
+        ObjIndex index;
+        uint8_t relative;
+        p = ParseFaceVertex(p, end, chunk.Data, index, relative);
+        if (cornerNum >= 3)     // 与第一个顶点和上一个顶点组成新的三角形
+        {
+            size_t last = indices.size() - 1;
+            indices.push_back(indices[first]);
+            indices.push_back(indices[last]);
+            relatives.push_back(relatives[first]);
+            relatives.push_back(relatives[last]);
+        }
+        indices.push_back(index);
+        relatives.push_back(relative);
+        chunk.HasRelative |= relative != 0;
+        cornerNum++;
+    }
+    ASSERT(cornerNum >= 3);
+    return p;
+}
+
+/**
+ * @brief 解析 [p, end) 内的所有行, 调用者保证该范围从行首开始
+*/
+void ParseChunk(const char* p, const char* end, ObjChunk& chunk)
+{
+    ObjData& data = chunk.Data;
+    while (p < end)
+    {
+        p = SkipSpaces(p, end);
+        if (p + 1 >= end)
+            break;
+
+        if (p[0] == 'v' && IsSpace(p[1]))                                   /* Position */
+        {
+            Vec3 position;
+            p = ParseFloats<3>(p + 2, end, &position.X);
+            data.Positions.push_back(position);
+        }
+        else if (p[0] == 'v' && p[1] == 't' && p + 2 < end && IsSpace(p[2]))    /* Texcoord */
+        {
+            Vec2 texCoord;
+            p = ParseFloats<2, 1>(p + 3, end, &texCoord.X);     // v 可省略
+            data.TexCoords.push_back(texCoord);
+        }
+        else if (p[0] == 'v' && p[1] == 'n' && p + 2 < end && IsSpace(p[2]))    /* Normal */
+        {
+            Vec3 normal;
+            p = ParseFloats<3>(p + 3, end, &normal.X);
+            data.Normals.push_back(normal);
+        }
+        else if (p[0] == 'f' && IsSpace(p[1]))                              /* Face */
+        {
+            p = ParseFace(p + 2, end, chunk);
+        }
+        // 注释与其余语句(o, g, s, usemtl 等)忽略, 已解析的行忽略行尾剩余内容
+        p = SkipLine(p, end);
+    }
+}
+
+template<typename value_t>
+void Append(std::vector<value_t>& dst, const std::vector<value_t>& src)
+{
+    dst.insert(dst.end(), src.begin(), src.end());
+}
+
+}
+
+void ParseObj(const char* text, const size_t size, ObjData& data)
+{
+    const char* end = text + size;
+
+    /* 按行边界切分 */
+    ThreadPool& threadPool = ThreadPool::Instance();
+    size_t chunkNum = std::max<size_t>(1, std::min<size_t>(threadPool.GetThreadCount() + 1, size / MIN_CHUNK_SIZE));
+    std::vector<const char*> bounds(chunkNum + 1, end);
+    bounds[0] = text;
+    for (size_t i = 1; i < chunkNum; i++)
+    {
+        const char* p = std::max(text + size / chunkNum * i, bounds[i - 1]);
+        bounds[i] = p > text ? SkipLine(p - 1, end) : p;
+    }
+
+    // 单块时负索引已经是全局索引, 无需修正
+    if (chunkNum == 1)
+    {
+        ObjChunk chunk;
+        ParseChunk(text, end, chunk);
+        data = std::move(chunk.Data);
+        return;
+    }
+
+    std::vector<ObjChunk> chunks(chunkNum);
+    threadPool.ParallelFor(0, (int)chunkNum, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; i++)
+                ParseChunk(bounds[i], bounds[i + 1], chunks[i]);
+        });
+
+    /* 按顺序拼接, 正索引是全局的, 负索引加上之前各块的属性数量 */
+    size_t positionNum = 0, texCoordNum = 0, normalNum = 0, indexNum = 0;
+    for (const ObjChunk& chunk : chunks)
+    {
+        positionNum += chunk.Data.Positions.size();
+        texCoordNum += chunk.Data.TexCoords.size();
+        normalNum += chunk.Data.Normals.size();
+        indexNum += chunk.Data.Indices.size();
+    }
+    data = {};
+    data.Positions.reserve(positionNum);
+    data.TexCoords.reserve(texCoordNum);
+    data.Normals.reserve(normalNum);
+    data.Indices.reserve(indexNum);
+    for (ObjChunk& chunk : chunks)
+    {
+        const int positionBase = (int)data.Positions.size();
+        const int texCoordBase = (int)data.TexCoords.size();
+        const int normalBase = (int)data.Normals.size();
+        const size_t indexBase = data.Indices.size();
+        Append(data.Positions, chunk.Data.Positions);
+        Append(data.TexCoords, chunk.Data.TexCoords);
+        Append(data.Normals, chunk.Data.Normals);
+        Append(data.Indices, chunk.Data.Indices);
+        if (chunk.HasRelative)
+        {
+            for (size_t i = 0; i < chunk.Relative.size(); i++)
+            {
+                uint8_t relative = chunk.Relative[i];
+                ObjIndex& index = data.Indices[indexBase + i];
+                if (relative & RELATIVE_POSITION)
+                    index.Position += positionBase;
+                if (relative & RELATIVE_TEXCOORD)
+                    index.TexCoord += texCoordBase;
+                if (relative & RELATIVE_NORMAL)
+                    index.Normal += normalBase;
+            }
+        }
+        chunk = {};
+    }
+}
+
+bool ParseObj(const std::string& path, ObjData& data)
+{
+    MappedFile file(path);
+    if (!file.IsValid())
+        return false;
+    ParseObj((const char*)file.GetData(), file.GetSize(), data);
+    return true;
+}
+
+}
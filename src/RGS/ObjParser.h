@@ -0,0 +1,39 @@
+#pragma once
+
+#include "RGS/Maths.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace RGS {
+
+struct ObjIndex
+{
+    int Position;       // 顶点位置索引, 从 0 开始
+    int TexCoord;       // 纹理坐标索引, -1 表示缺失
+    int Normal;         // 法线索引, -1 表示缺失
+};
+
+struct ObjData
+{
+    std::vector<Vec3> Positions;
+    std::vector<Vec2> TexCoords;
+    std::vector<Vec3> Normals;
+    std::vector<ObjIndex> Indices;      // 每 3 个为一个三角形, 多边形面已按扇形三角化
+};
+
+/**
+ * @brief 解析 OBJ 文件: 内存映射整个文件, 按行边界切分为若干块在线程池中并行解析后合并
+ *        面支持 v、v/vt、v//vn、v/vt/vn 形式与负索引, 多边形面按扇形三角化; vt 只有 u 分量时 v 为 0
+ * @param path 文件路径
+ * @param data 输出的顶点属性与索引
+ * @return 文件无法打开或映射时返回 false
+*/
+bool ParseObj(const std::string& path, ObjData& data);
+/**
+ * @brief 解析内存中的 OBJ 文本
+*/
+void ParseObj(const char* text, const size_t size, ObjData& data);
+
+}
@@ -34,11 +34,6 @@ namespace RGS {
         }
     }
 
-    bool Renderer::IsInsideTriangle(float(&weights)[3])
-    {
-        return weights[0] >= -EPSILON && weights[1] >= -EPSILON && weights[2] >= -EPSILON;
-    }
-
     bool Renderer::IsBackFacing(const Vec4& a, const Vec4& b, const Vec4& c)
     {
         // 逆时针为正面 （可见）(叉乘判断正反面)
@@ -56,7 +51,9 @@ namespace RGS {
             case DepthFuncType::LESS:
                 return fDepth - writeDepth > EPSILON;
             case DepthFuncType::LEQUAL:
-                return fDepth - writeDepth >= EPSILON;
+                return fDepth - writeDepth >= -EPSILON;
+            case DepthFuncType::EQUAL:
+                return fabs(fDepth - writeDepth) <= EPSILON;
             case DepthFuncType::ALWAYS:
                 return true;
             default:
@@ -1,14 +1,19 @@
 #pragma once
 
 #include "RGS/Framebuffer.h"
+#include "RGS/GBuffer.h"
 #include "RGS/Base.h"
 #include "RGS/Maths.h"
+#include "RGS/MeshletCulling.h"
 #include "Shaders/ShaderBase.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <type_traits>
 #include <cmath>
+#include <optional>
+#include <vector>
 
 
 namespace RGS {
@@ -41,6 +46,7 @@ enum class DepthFuncType
 {
     LESS,           // 小于
     LEQUAL,         // 小于等于
+    EQUAL,          // 等于(配合深度预渲染, 只着色最终可见的表面)
     ALWAYS,         // 总是
 };
 
@@ -49,6 +55,7 @@ struct Program
 {
     bool EnableDepthTest = true;      // 是否启用深度测试
     bool EnableWriteDepth = true;     // 是否启用深度写入
+    bool EnableWriteColor = true;     // 是否启用颜色写入, 关闭时不执行片段着色器(用于深度预渲染)
     bool EnableBlend = false;          // 是否启用混合
     bool EnableDoubleSided = false;   // 是否启用双面渲染
 
@@ -57,14 +64,77 @@ struct Program
     using vertex_shader_t = void (*)(varyings_t&, const vertex_t&, const uniforms_t&);
     vertex_shader_t VertexShader;   // 顶点着色器
 
+    // 实例化顶点着色器, 逐实例数据按实例编号从实例缓冲读取, 供 Renderer::DrawInstanced 使用
+    using instanced_vertex_shader_t = void (*)(varyings_t&, const vertex_t&, const InstanceBuffer&, const uint32_t instance, const uniforms_t&);
+    instanced_vertex_shader_t InstancedVertexShader = nullptr;   // 实例化顶点着色器
+
+    // 逐实例更新统一变量, 用于片段阶段需要的实例常量(如颜色), 这类常量在三角形内不变, 不需要作为插值变量
+    using instance_uniforms_t = void (*)(uniforms_t&, const InstanceBuffer&, const uint32_t instance);
+    instance_uniforms_t InstanceUniforms = nullptr;
+
     // discard 为true表示当前判断片段被丢弃 
     using fragment_shader_t = Vec4(*)(bool& discard, const varyings_t&, const uniforms_t&);
-    fragment_shader_t FragmentShader;   // 片段着色器
+    fragment_shader_t FragmentShader = nullptr;   // 片段着色器
+
+    // 带导数的片段着色器, ddx/ddy 为插值变量沿屏幕 x/y 方向的差分(按 2x2 像素块计算), 用于纹理 mipmap 选择
+    using fragment_shader_dd_t = Vec4(*)(bool& discard, const varyings_t&, const varyings_t& ddx, const varyings_t& ddy, const uniforms_t&);
+    fragment_shader_dd_t FragmentShaderDD = nullptr;   // 带导数的片段着色器
 
     Program(const vertex_shader_t vertexShader, const fragment_shader_t fragmentShader)
         : VertexShader(vertexShader),
         FragmentShader(fragmentShader)
     {}
+
+    Program(const vertex_shader_t vertexShader, const fragment_shader_dd_t fragmentShader)
+        : VertexShader(vertexShader),
+        FragmentShaderDD(fragmentShader)
+    {}
+
+    bool NeedsDerivatives() const { return FragmentShaderDD != nullptr; }    // 是否需要按 2x2 像素块光栅化
+};
+
+/**
+ * @brief 延迟渲染几何阶段的着色器程序, 片段着色器输出表面信息而不是颜色
+*/
+template<typename vertex_t, typename uniforms_t, typename varyings_t>
+struct GeometryProgram 
+{
+    bool EnableDepthTest = true;      // 是否启用深度测试
+    bool EnableWriteDepth = true;     // 是否启用深度写入
+    bool EnableDoubleSided = false;   // 是否启用双面渲染
+
+    DepthFuncType DepFunc = DepthFuncType::LESS;        // 深度测试函数类型
+
+    using vertex_shader_t = void (*)(varyings_t&, const vertex_t&, const uniforms_t&);
+    vertex_shader_t VertexShader;   // 顶点着色器
+
+    // 实例化顶点着色器, 逐实例数据按实例编号从实例缓冲读取, 供 Renderer::DrawGeometryInstanced 使用
+    using instanced_vertex_shader_t = void (*)(varyings_t&, const vertex_t&, const InstanceBuffer&, const uint32_t instance, const uniforms_t&);
+    instanced_vertex_shader_t InstancedVertexShader = nullptr;   // 实例化顶点着色器
+
+    // 逐实例更新统一变量, 用于片段阶段需要的实例常量(如颜色), 这类常量在三角形内不变, 不需要作为插值变量
+    using instance_uniforms_t = void (*)(uniforms_t&, const InstanceBuffer&, const uint32_t instance);
+    instance_uniforms_t InstanceUniforms = nullptr;
+
+    // discard 为true表示当前判断片段被丢弃 
+    // ddx/ddy 为插值变量沿屏幕 x/y 方向的差分, 用于纹理 mipmap 选择
+    using geometry_shader_t = void (*)(bool& discard, GBufferTexel&, const varyings_t&, const varyings_t& ddx, const varyings_t& ddy, const uniforms_t&);
+    geometry_shader_t GeometryShader;   // 几何片段着色器
+
+    GeometryProgram(const vertex_shader_t vertexShader, const geometry_shader_t geometryShader)
+        : VertexShader(vertexShader),
+        GeometryShader(geometryShader)
+    {}
+};
+
+/**
+ * @brief 只写深度的绘制状态, 没有着色器和颜色写入(用于深度预渲染与阴影贴图)
+*/
+struct DepthProgram
+{
+    bool EnableDoubleSided = false;   // 是否启用双面渲染
+
+    DepthFuncType DepFunc = DepthFuncType::LESS;        // 深度测试函数类型
 };
 
 
@@ -72,6 +142,11 @@ class Renderer
 {
 private:
     static constexpr int RGS_MAX_VARYINGS = 9;      // 最大插值变量数目
+    static constexpr int RGS_MSAA_SAMPLES = 4;      // 多重采样数目
+    // 4x MSAA 旋转网格采样位置(相对像素左下角), 与 D3D 标准采样模式一致
+    static constexpr float RGS_MSAA_SAMPLE_POSITIONS[RGS_MSAA_SAMPLES][2] = {
+        { 0.375f, 0.125f }, { 0.875f, 0.375f }, { 0.125f, 0.625f }, { 0.625f, 0.875f }
+    };
 
 private:
     enum class Plane        
@@ -89,6 +164,44 @@ private:
 
     struct BoundingBox { int MinX, MaxX, MinY, MaxY; };   // 视锥体
 
+    // 以 v0 为原点的归一化边函数 e(x, y) = A * (x - v0.X) + B * (y - v0.Y), 即 v1、v2 对应的屏幕空间重心坐标(v0 对应 1 - e1 - e2)
+    // 所有光栅化函数都用它判断覆盖, 深度预渲染与着色阶段因此覆盖完全相同的像素
+    struct EdgeFunctions
+    {
+        float OriginX, OriginY;
+        float A1, B1, A2, B2;
+
+        /**
+         * @return 三角形有向面积的两倍, 为 0 时三角形退化, 边函数无效
+        */
+        float Setup(const Vec4(&fragCoords)[3])
+        {
+            const Vec4& v0 = fragCoords[0];
+            const Vec4& v1 = fragCoords[1];
+            const Vec4& v2 = fragCoords[2];
+            const float area = (v1.X - v0.X) * (v2.Y - v0.Y) - (v1.Y - v0.Y) * (v2.X - v0.X);
+            if (area == 0.0f)
+                return area;
+            const float invArea = 1.0f / area;
+            OriginX = v0.X;
+            OriginY = v0.Y;
+            A1 = (v2.Y - v0.Y) * invArea; B1 = (v0.X - v2.X) * invArea;
+            A2 = (v0.Y - v1.Y) * invArea; B2 = (v1.X - v0.X) * invArea;
+            return area;
+        }
+        /**
+         * @brief 屏幕坐标 (x, y) 是否在三角形内
+        */
+        bool Covers(const float x, const float y) const
+        {
+            const float px = x - OriginX;
+            const float py = y - OriginY;
+            const float e1 = A1 * px + B1 * py;
+            const float e2 = A2 * px + B2 * py;
+            return e1 >= -EPSILON && e2 >= -EPSILON && 1.0f - e1 - e2 >= -EPSILON;
+        }
+    };
+
     /**
      * @brief 判断点是否在视锥体内
      * @param clipPos 裁剪空间坐标
@@ -100,11 +213,6 @@ private:
      * @param plane 平面
     */
     static bool IsInsidePlane(const Vec4& clipPos, const Plane plane);
-    /**
-     * @brief 判断点是否在三角形内
-     * @param weights 三角形比例
-    */
-    static bool IsInsideTriangle(float (&weights)[3]);
     /**
      * @brief 判断是否是背面
     */
@@ -153,6 +261,22 @@ private:
             outFloat[i] = Lerp(startFloat[i], endFloat[i], ratio);
         }
     }
+    /**
+     * @brief 逐分量相减, 用于计算插值变量的屏幕空间差分
+    */
+    template <typename varyings_t>
+    static void DiffVaryings(varyings_t& out, const varyings_t& left, const varyings_t& right)
+    {
+        constexpr uint32_t floatNum = sizeof(varyings_t) / sizeof(float);
+        const float* leftFloat = (const float*)&left;
+        const float* rightFloat = (const float*)&right;
+        float* outFloat = (float*)&out;
+
+        for (int i = 0; i < (int)floatNum; i++)
+        {
+            outFloat[i] = leftFloat[i] - rightFloat[i];
+        }
+    }
     /**
      * @brief 计算三角形的插值变量
     */
@@ -168,8 +292,8 @@ private:
                         varyings[2].ClipPos * weights[2];
         out.NdcPos = out.ClipPos / out.ClipPos.W;
         out.NdcPos.W = 1.0f / out.ClipPos.W;
-        out.FragPos.X = ((out.NdcPos.X + 1.0f) * 0.5f * 600);
-        out.FragPos.Y = ((out.NdcPos.Y + 1.0f) * 0.5f * 300);
+        out.FragPos.X = ((out.NdcPos.X + 1.0f) * 0.5f * width);
+        out.FragPos.Y = ((out.NdcPos.Y + 1.0f) * 0.5f * height);
         out.FragPos.Z = (out.NdcPos.Z + 1.0f) * 0.5f;
         out.FragPos.W = out.NdcPos.W;
 
@@ -305,26 +429,65 @@ private:
         }
     }
 
+    /**
+     * @brief 执行片段着色器并限制颜色范围
+     * @param color 输出颜色
+     * @param ddx 插值变量沿 x 方向的差分, 片段着色器不需要导数时可为空
+     * @param ddy 插值变量沿 y 方向的差分
+     * @return 片段是否保留(未被 discard)
+    */
     template <typename vertex_t, typename uniforms_t, typename varyings_t>
-    static void ProcessPixel(Framebuffer& framebuffer,
-                                const int x,
-                                const int y,
+    static bool ShadeFragment(Vec4& color,
                                 const Program<vertex_t, uniforms_t, varyings_t>& program,
                                 const varyings_t& varyings,
+                                const varyings_t* ddx,
+                                const varyings_t* ddy,
                                 const uniforms_t& uniforms)
     {
-        /* Pixel Shading */
         bool discard = false;
-        Vec4 color{ 0.0f, 0.0f, 0.0f, 0.0f };
-        color = program.FragmentShader(discard, varyings, uniforms);
+        if (program.NeedsDerivatives())
+        {
+            ASSERT(ddx && ddy);
+            color = program.FragmentShaderDD(discard, varyings, *ddx, *ddy, uniforms);
+        }
+        else
+        {
+            color = program.FragmentShader(discard, varyings, uniforms);
+        }
         if (discard)
         {
-            return;
+            return false;
         }
         color.X = Clamp(color.X, 0.0f, 1.0f);
         color.Y = Clamp(color.Y, 0.0f, 1.0f);
         color.Z = Clamp(color.Z, 0.0f, 1.0f);
         color.W = Clamp(color.W, 0.0f, 1.0f);
+        return true;
+    }
+
+    template <typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void ProcessPixel(Framebuffer& framebuffer,
+                                const int x,
+                                const int y,
+                                const Program<vertex_t, uniforms_t, varyings_t>& program,
+                                const varyings_t& varyings,
+                                const varyings_t* ddx,
+                                const varyings_t* ddy,
+                                const uniforms_t& uniforms)
+    {
+        if (!program.EnableWriteColor)      // 只写入深度
+        {
+            if (program.EnableWriteDepth)
+                framebuffer.SetDepth(x, y, varyings.FragPos.Z);
+            return;
+        }
+
+        /* Pixel Shading */
+        Vec4 color{ 0.0f, 0.0f, 0.0f, 0.0f };
+        if (!ShadeFragment(color, program, varyings, ddx, ddy, uniforms))
+        {
+            return;
+        }
 
         /* Blend (混合) */ /* 用于透明物体 */
         if (program.EnableBlend)    // 如果启用混合
@@ -347,21 +510,72 @@ private:
         }
     }
 
+    /**
+     * @brief 多重采样的像素处理, 片段着色器每像素只执行一次, 颜色写入覆盖且通过深度测试的采样
+     * @param mask 采样掩码, 第 i 位表示第 i 个采样需要写入
+     * @param sampleDepths 各采样的深度
+    */
+    template <typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void ProcessSamples(Framebuffer& framebuffer,
+                                const int x,
+                                const int y,
+                                const uint32_t mask,
+                                const float(&sampleDepths)[RGS_MSAA_SAMPLES],
+                                const Program<vertex_t, uniforms_t, varyings_t>& program,
+                                const varyings_t& varyings,
+                                const varyings_t* ddx,
+                                const varyings_t* ddy,
+                                const uniforms_t& uniforms)
+    {
+        Vec4 color{ 0.0f, 0.0f, 0.0f, 0.0f };
+        if (program.EnableWriteColor && !ShadeFragment(color, program, varyings, ddx, ddy, uniforms))
+        {
+            return;
+        }
+
+        for (int i = 0; i < RGS_MSAA_SAMPLES; i++)
+        {
+            if (!(mask & (1u << i)))
+                continue;
+
+            if (program.EnableWriteColor)
+            {
+                Vec3 srcColor = color;
+                if (program.EnableBlend)
+                {
+                    Vec3 dstColor = framebuffer.GetSampleColor(x, y, i);
+                    srcColor = Lerp(dstColor, srcColor, color.W);
+                }
+                framebuffer.SetSampleColor(x, y, i, srcColor);
+            }
+
+            if (program.EnableWriteDepth)
+            {
+                framebuffer.SetSampleDepth(x, y, i, sampleDepths[i]);
+            }
+        }
+    }
+
     /**
      * @brief 绘制三角形
-     * @param framebuffer 帧缓存
-     * @param program 着色器程序
+     * @param width 屏幕宽度
+     * @param height 屏幕高度
+     * @param doubleSided 是否启用双面渲染
+     * @param derivatives 是否按 2x2 像素块光栅化并计算插值变量的屏幕空间差分
      * @param varyings 输入插值变量
-     * @param uniforms 统一变量
+     * @param pixelFunc 像素处理函数, 对三角形覆盖的每个像素调用 pixelFunc(x, y, pixVaryings, ddx, ddy),
+     *                  不计算导数时 ddx/ddy 为空
     */
-    template<typename vertex_t, typename uniforms_t, typename varyings_t>
-    static void RasterizeTriangle(Framebuffer& framebuffer,
-                                const Program<vertex_t, uniforms_t, varyings_t>& program,
+    template<typename varyings_t, typename pixel_func_t>
+    static void RasterizeTriangle(const int width,
+                                const int height,
+                                const bool doubleSided,
+                                const bool derivatives,
                                 const varyings_t(&varyings)[3],
-                                const uniforms_t& uniforms)
+                                pixel_func_t&& pixelFunc)
     {
         /* Back Face Culling(背向剔除) */
-        if (!program.EnableDoubleSided)     // 如果没有开启双面渲染
+        if (!doubleSided)     // 如果没有开启双面渲染
         {
             bool isBackFacing = false;
             isBackFacing = IsBackFacing(varyings[0].NdcPos, varyings[1].NdcPos, varyings[2].NdcPos);
@@ -371,81 +585,272 @@ private:
             }
         }
 
-        int width = framebuffer.GetWidth();
-        int height = framebuffer.GetHeight();
         /* Bounding Box Setup */
         Vec4 fragCoords[3];
         fragCoords[0] = varyings[0].FragPos;
         fragCoords[1] = varyings[1].FragPos;
         fragCoords[2] = varyings[2].FragPos;
         BoundingBox bBox = GetBoundingBox(fragCoords, width, height);
+        EdgeFunctions edges;
+        if (edges.Setup(fragCoords) == 0.0f)
+            return;
+
+        if (derivatives)
+        {
+            /* 2x2 Quad Rasterization (像素块内所有像素都计算插值变量, 块外的辅助像素只用于求差分) */
+            for (int y = bBox.MinY & ~1; y <= bBox.MaxY; y += 2)
+            {
+                for (int x = bBox.MinX & ~1; x <= bBox.MaxX; x += 2)
+                {
+                    float weights[4][3];
+                    bool inside[4];
+                    bool anyInside = false;
+                    for (int i = 0; i < 4; i++)
+                    {
+                        int px = x + (i & 1);
+                        int py = y + (i >> 1);
+                        float screenWeights[3];
+                        Vec2 screenPoint{ (float)px + 0.5f, (float)py + 0.5f };
+                        CalculateWeights(screenWeights, weights[i], fragCoords, screenPoint);
+                        inside[i] = px < width && py < height && edges.Covers(screenPoint.X, screenPoint.Y);
+                        anyInside = anyInside || inside[i];
+                    }
+                    if (!anyInside)
+                        continue;
+
+                    varyings_t quadVaryings[4];
+                    for (int i = 0; i < 4; i++)
+                    {
+                        LerpVaryings(quadVaryings[i], varyings, weights[i], width, height);
+                    }
+                    varyings_t ddx, ddy;
+                    DiffVaryings(ddx, quadVaryings[1], quadVaryings[0]);
+                    DiffVaryings(ddy, quadVaryings[2], quadVaryings[0]);
+
+                    for (int i = 0; i < 4; i++)
+                    {
+                        if (inside[i])
+                            pixelFunc(x + (i & 1), y + (i >> 1), quadVaryings[i], &ddx, &ddy);
+                    }
+                }
+            }
+            return;
+        }
 
         for (int y = bBox.MinY; y <= bBox.MaxY; y++)
         {
             for (int x = bBox.MinX; x <= bBox.MaxX; x++)
             {
+                Vec2 screenPoint{ (float)x + 0.5f, (float)y + 0.5f };
+                if (!edges.Covers(screenPoint.X, screenPoint.Y))
+                    continue;
+
                 /* Varyings Setup */
                 float screenWeights[3];
                 float weights[3];
-                Vec2 screenPoint{ (float)x + 0.5f, (float)y + 0.5f };
-
                 CalculateWeights(screenWeights, weights, fragCoords, screenPoint);
-                if (!IsInsideTriangle(weights))
-                    continue;
 
                 varyings_t pixVaryings;
                 LerpVaryings(pixVaryings, varyings, weights, width, height);
 
-                /* Early Depth Test (深度测试) */
-                if (program.EnableDepthTest)
+                pixelFunc(x, y, pixVaryings, (const varyings_t*)nullptr, (const varyings_t*)nullptr);
+            }
+        }
+    }
+
+    /**
+     * @brief 多重采样三角形光栅化, 逐采样计算覆盖掩码与深度, 每像素只着色一次
+     * @param framebuffer 多重采样帧缓存
+     * @param program 着色器程序
+     * @param varyings 输入插值变量
+     * @param uniforms 统一变量
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void RasterizeTriangleMultisample(Framebuffer& framebuffer,
+                                const Program<vertex_t, uniforms_t, varyings_t>& program,
+                                const varyings_t(&varyings)[3],
+                                const uniforms_t& uniforms)
+    {
+        ASSERT(framebuffer.GetSampleCount() == RGS_MSAA_SAMPLES);
+
+        /* Back Face Culling(背向剔除) */
+        if (!program.EnableDoubleSided)
+        {
+            if (IsBackFacing(varyings[0].NdcPos, varyings[1].NdcPos, varyings[2].NdcPos))
+            {
+                return;
+            }
+        }
+
+        const Vec4& v0 = varyings[0].FragPos;
+        const Vec4& v1 = varyings[1].FragPos;
+        const Vec4& v2 = varyings[2].FragPos;
+        Vec4 fragCoords[3] = { v0, v1, v2 };
+
+        /* Triangle Setup */
+        EdgeFunctions edges;
+        if (edges.Setup(fragCoords) == 0.0f)
+            return;
+        const float dzdx = edges.A1 * (v1.Z - v0.Z) + edges.A2 * (v2.Z - v0.Z);
+        const float dzdy = edges.B1 * (v1.Z - v0.Z) + edges.B2 * (v2.Z - v0.Z);
+
+        int width = framebuffer.GetWidth();
+        int height = framebuffer.GetHeight();
+        BoundingBox bBox = GetBoundingBox(fragCoords, width, height);
+
+        for (int y = bBox.MinY; y <= bBox.MaxY; y++)
+        {
+            for (int x = bBox.MinX; x <= bBox.MaxX; x++)
+            {
+                /* Coverage (逐采样覆盖测试与深度) */
+                uint32_t mask = 0;
+                int firstSample = -1;
+                float sampleDepths[RGS_MSAA_SAMPLES];
+                for (int i = 0; i < RGS_MSAA_SAMPLES; i++)
                 {
-                    float depth = pixVaryings.FragPos.Z;
-                    float fDepth = framebuffer.GetDepth(x, y);
-                    DepthFuncType depthFunc = program.DepFunc;
-                    if (!PassDepthTest(depth, fDepth, depthFunc))
-                    {
+                    float sampleX = (float)x + RGS_MSAA_SAMPLE_POSITIONS[i][0];
+                    float sampleY = (float)y + RGS_MSAA_SAMPLE_POSITIONS[i][1];
+                    if (!edges.Covers(sampleX, sampleY))
                         continue;
-                    }
+
+                    sampleDepths[i] = v0.Z + dzdx * (sampleX - v0.X) + dzdy * (sampleY - v0.Y);
+                    /* Early Depth Test (逐采样深度测试) */
+                    if (program.EnableDepthTest &&
+                        !PassDepthTest(sampleDepths[i], framebuffer.GetSampleDepth(x, y, i), program.DepFunc))
+                        continue;
+
+                    mask |= 1u << i;
+                    if (firstSample < 0)
+                        firstSample = i;
+                }
+                if (mask == 0)
+                    continue;
+
+                /* Varyings Setup (着色点取像素中心, 中心不在三角形内时取第一个被覆盖的采样, 避免外插) */
+                float screenWeights[3];
+                float weights[3];
+                Vec2 screenPoint{ (float)x + 0.5f, (float)y + 0.5f };
+                CalculateWeights(screenWeights, weights, fragCoords, screenPoint);
+                if (!edges.Covers(screenPoint.X, screenPoint.Y))
+                {
+                    screenPoint = { (float)x + RGS_MSAA_SAMPLE_POSITIONS[firstSample][0],
+                                    (float)y + RGS_MSAA_SAMPLE_POSITIONS[firstSample][1] };
+                    CalculateWeights(screenWeights, weights, fragCoords, screenPoint);
+                }
+
+                varyings_t pixVaryings;
+                LerpVaryings(pixVaryings, varyings, weights, width, height);
+
+                /* Derivatives (多重采样逐像素着色, 直接在着色点右侧与上方一个像素处求差分) */
+                varyings_t ddx, ddy;
+                if (program.NeedsDerivatives())
+                {
+                    varyings_t neighbor;
+                    CalculateWeights(screenWeights, weights, fragCoords, { screenPoint.X + 1.0f, screenPoint.Y });
+                    LerpVaryings(neighbor, varyings, weights, width, height);
+                    DiffVaryings(ddx, neighbor, pixVaryings);
+                    CalculateWeights(screenWeights, weights, fragCoords, { screenPoint.X, screenPoint.Y + 1.0f });
+                    LerpVaryings(neighbor, varyings, weights, width, height);
+                    DiffVaryings(ddy, neighbor, pixVaryings);
                 }
 
                 /* Pixel Processing */
-                ProcessPixel(framebuffer, x, y, program, pixVaryings, uniforms);
+                ProcessSamples(framebuffer, x, y, mask, sampleDepths, program, pixVaryings, &ddx, &ddy, uniforms);
             }
         }
     }
 
-public:
     /**
-     * @brief 绘制
+     * @brief 只写深度的三角形光栅化, 不插值其他变量, 在屏幕空间增量计算深度
      * @param framebuffer 帧缓存
-     * @param program 着色器程序
-     * @param triangle 三角形
-     * @param uniforms 统一变量
+     * @param doubleSided 是否启用双面渲染
+     * @param fragCoords 三个顶点的屏幕坐标
+     * @param depthTest 深度测试函数 depthTest(writeDepth, fDepth)
     */
-    template<typename vertex_t, typename uniforms_t, typename varyings_t>
-    static void Draw(Framebuffer& framebuffer,
-                    const Program<vertex_t, uniforms_t, varyings_t>& program,
-                    const Triangle<vertex_t>& triangle,
-                    const uniforms_t& uniforms)
+    template<typename depth_test_t>
+    static void RasterizeDepthTriangle(Framebuffer& framebuffer,
+                                const bool doubleSided,
+                                const Vec4(&fragCoords)[3],
+                                depth_test_t&& depthTest)
     {
-        static_assert(std::is_base_of_v<VertexBase, vertex_t>, "vertex_t 必须继承自 RGS::VertexBase");
-        static_assert(std::is_base_of_v<VaryingsBase, varyings_t>, "varyings_t 必须继承自 RGS::VaryingsBase");
+        const Vec4& v0 = fragCoords[0];
+        const Vec4& v1 = fragCoords[1];
+        const Vec4& v2 = fragCoords[2];
 
-        /* Vertex Shading & Projection */
-        varyings_t varyings[RGS_MAX_VARYINGS];
-        for (int i = 0; i < 3; i++)
+        /* Triangle Setup (覆盖测试与着色阶段相同, 见 EdgeFunctions) */
+        EdgeFunctions edges;
+        float area = edges.Setup(fragCoords);
+        if (area <= 0.0f)   // 背面或退化三角形
         {
-            program.VertexShader(varyings[i], triangle[i], uniforms);
+            if (!doubleSided || area == 0.0f)
+                return;
+        }
+
+        // 深度平面方程 z(x, y) = v0.Z + dzdx * (x - v0.X) + dzdy * (y - v0.Y)
+        const float dzdx = edges.A1 * (v1.Z - v0.Z) + edges.A2 * (v2.Z - v0.Z);
+        const float dzdy = edges.B1 * (v1.Z - v0.Z) + edges.B2 * (v2.Z - v0.Z);
+
+        const int width = framebuffer.GetWidth();
+        const int height = framebuffer.GetHeight();
+        BoundingBox bBox = GetBoundingBox(fragCoords, width, height);
+        float* depthBuffer = framebuffer.GetDepthBuffer();
+
+        for (int y = bBox.MinY; y <= bBox.MaxY; y++)
+        {
+            const float sampleY = (float)y + 0.5f;
+            float z = v0.Z + dzdx * ((float)bBox.MinX + 0.5f - v0.X) + dzdy * (sampleY - v0.Y);
+            float* depthRow = depthBuffer + y * width;
+
+            bool entered = false;
+            for (int x = bBox.MinX; x <= bBox.MaxX; x++)
+            {
+                if (edges.Covers((float)x + 0.5f, sampleY))
+                {
+                    entered = true;
+                    if (depthTest(z, depthRow[x]))
+                        depthRow[x] = z;
+                }
+                else if (entered)   // 三角形是凸的, 离开后本行不会再进入
+                {
+                    break;
+                }
+                z += dzdx;
+            }
         }
+    }
 
+    /**
+     * @brief 裁剪与屏幕映射
+     * @param varyings 插值变量, 前 3 个为已完成顶点着色的三角形顶点, 输出裁剪后的多边形顶点
+     * @param width 屏幕宽度
+     * @param height 屏幕高度
+     * @return 裁剪后的顶点数目
+    */
+    template<typename varyings_t>
+    static int ClipAndMap(varyings_t(&varyings)[RGS_MAX_VARYINGS], const int width, const int height)
+    {
         /* Clipping */
         int vertexNum = Clip(varyings);
 
         /* Screen Mapping */
         CaculateNdcPos(varyings, vertexNum);
+        CaculateFragPos(varyings, vertexNum, (float)width, (float)height);
+
+        return vertexNum;
+    }
+
+    /**
+     * @brief 裁剪、三角形装配与光栅化已完成顶点着色的三角形
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawShaded(Framebuffer& framebuffer,
+                    const Program<vertex_t, uniforms_t, varyings_t>& program,
+                    varyings_t(&varyings)[RGS_MAX_VARYINGS],
+                    const uniforms_t& uniforms)
+    {
         int fWidth = framebuffer.GetWidth();
         int fHeight = framebuffer.GetHeight();
-        CaculateFragPos(varyings, vertexNum, (float)fWidth, (float)fHeight);
+        int vertexNum = ClipAndMap(varyings, fWidth, fHeight);
 
         /* Triangle Assembly & Rasterization */
         for (int i = 0; i < vertexNum - 2; i++)
@@ -455,9 +860,654 @@ public:
             triVaryings[1] = varyings[i + 1];
             triVaryings[2] = varyings[i + 2];
 
-            RasterizeTriangle(framebuffer, program, triVaryings, uniforms);
+            if (framebuffer.GetSampleCount() > 1)
+            {
+                RasterizeTriangleMultisample(framebuffer, program, triVaryings, uniforms);
+                continue;
+            }
+
+            RasterizeTriangle(fWidth, fHeight, program.EnableDoubleSided, program.NeedsDerivatives(), triVaryings,
+                [&](const int x, const int y, const varyings_t& pixVaryings, const varyings_t* ddx, const varyings_t* ddy)
+                {
+                    /* Early Depth Test (深度测试) */
+                    if (program.EnableDepthTest)
+                    {
+                        float depth = pixVaryings.FragPos.Z;
+                        float fDepth = framebuffer.GetDepth(x, y);
+                        DepthFuncType depthFunc = program.DepFunc;
+                        if (!PassDepthTest(depth, fDepth, depthFunc))
+                        {
+                            return;
+                        }
+                    }
+
+                    /* Pixel Processing */
+                    ProcessPixel(framebuffer, x, y, program, pixVaryings, ddx, ddy, uniforms);
+                });
         }
     }
+
+    /**
+     * @brief 延迟渲染几何阶段: 裁剪、三角形装配与光栅化已完成顶点着色的三角形
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawShaded(GBuffer& gbuffer,
+                    const GeometryProgram<vertex_t, uniforms_t, varyings_t>& program,
+                    varyings_t(&varyings)[RGS_MAX_VARYINGS],
+                    const uniforms_t& uniforms)
+    {
+        int gWidth = gbuffer.GetWidth();
+        int gHeight = gbuffer.GetHeight();
+        int vertexNum = ClipAndMap(varyings, gWidth, gHeight);
+
+        /* Triangle Assembly & Rasterization */
+        for (int i = 0; i < vertexNum - 2; i++)
+        {
+            varyings_t triVaryings[3];
+            triVaryings[0] = varyings[0];
+            triVaryings[1] = varyings[i + 1];
+            triVaryings[2] = varyings[i + 2];
+
+            RasterizeTriangle(gWidth, gHeight, program.EnableDoubleSided, true, triVaryings,
+                [&](const int x, const int y, const varyings_t& pixVaryings, const varyings_t* ddx, const varyings_t* ddy)
+                {
+                    float depth = pixVaryings.FragPos.Z;
+                    if (program.EnableDepthTest && !PassDepthTest(depth, gbuffer.GetDepth(x, y), program.DepFunc))
+                    {
+                        return;
+                    }
+
+                    bool discard = false;
+                    GBufferTexel texel;
+                    program.GeometryShader(discard, texel, pixVaryings, *ddx, *ddy, uniforms);
+                    if (discard)
+                    {
+                        return;
+                    }
+                    gbuffer.SetTexel(x, y, texel);
+
+                    if (program.EnableWriteDepth)
+                    {
+                        gbuffer.SetDepth(x, y, depth);
+                    }
+                });
+        }
+    }
+
+    /**
+     * @brief 只写深度: 裁剪、三角形装配与光栅化已变换到裁剪空间的三角形
+    */
+    static void DrawDepthTransformed(Framebuffer& framebuffer,
+                    const DepthProgram& program,
+                    VaryingsBase(&varyings)[RGS_MAX_VARYINGS])
+    {
+        int vertexNum = ClipAndMap(varyings, framebuffer.GetWidth(), framebuffer.GetHeight());
+
+        /* Triangle Assembly & Rasterization */
+        for (int i = 0; i < vertexNum - 2; i++)
+        {
+            Vec4 fragCoords[3];
+            fragCoords[0] = varyings[0].FragPos;
+            fragCoords[1] = varyings[i + 1].FragPos;
+            fragCoords[2] = varyings[i + 2].FragPos;
+
+            switch (program.DepFunc)
+            {
+            case DepthFuncType::LESS:
+                RasterizeDepthTriangle(framebuffer, program.EnableDoubleSided, fragCoords,
+                    [](const float writeDepth, const float fDepth) { return fDepth - writeDepth > EPSILON; });
+                break;
+            case DepthFuncType::LEQUAL:
+                RasterizeDepthTriangle(framebuffer, program.EnableDoubleSided, fragCoords,
+                    [](const float writeDepth, const float fDepth) { return fDepth - writeDepth >= -EPSILON; });
+                break;
+            default:
+                RasterizeDepthTriangle(framebuffer, program.EnableDoubleSided, fragCoords,
+                    [&](const float writeDepth, const float fDepth) { return PassDepthTest(writeDepth, fDepth, program.DepFunc); });
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief 按需着色的顶点缓存, 只为可见网格簇引用到的顶点执行顶点着色
+    */
+    template<typename shaded_t>
+    struct LazyShadedVertices
+    {
+        std::vector<shaded_t> Varyings;
+        std::vector<uint32_t> Stamps;       // 顶点最近一次着色时的绘制编号
+        uint32_t DrawId = 0;
+
+        void Begin(const size_t vertexCount)
+        {
+            Varyings.resize(vertexCount);
+            Stamps.resize(vertexCount, 0);
+            if (++DrawId == 0)
+            {
+                std::fill(Stamps.begin(), Stamps.end(), 0);
+                DrawId = 1;
+            }
+        }
+    };
+
+    // 一次绘制的三角形: 索引缓冲中的一段, 或一组网格簇(网格簇的索引位置指向 Indices)
+    struct IndexRange
+    {
+        const uint32_t* Indices;
+        size_t IndexCount;
+        const Meshlet* Meshlets;
+        size_t MeshletCount;
+    };
+
+    /**
+     * @brief 所有索引与网格簇绘制的公共流程
+     *        culling 为空时对所有顶点着色一次后按索引绘制; 否则逐个剔除网格簇, 只对可见簇引用的顶点着色
+     * @param doubleSided 双面渲染时不做法线锥背面剔除
+     * @param shade 顶点着色 shade(out, index)
+     * @param draw 绘制一个已着色的三角形 draw(v0, v1, v2)
+    */
+    template<typename shaded_t, typename shade_func_t, typename draw_func_t>
+    static void DrawTriangles(LazyShadedVertices<shaded_t>& cache,
+                    const size_t vertexCount,
+                    const IndexRange& range,
+                    const MeshletCulling* culling,
+                    const bool doubleSided,
+                    shade_func_t&& shade,
+                    draw_func_t&& draw)
+    {
+        const uint32_t* indices = range.Indices;
+        if (!culling)
+        {
+            /* Vertex Shading (共享顶点只着色一次) */
+            cache.Varyings.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                shade(cache.Varyings[i], (uint32_t)i);
+            }
+            for (size_t i = 0; i + 2 < range.IndexCount; i += 3)
+            {
+                draw(cache.Varyings[indices[i]], cache.Varyings[indices[i + 1]], cache.Varyings[indices[i + 2]]);
+            }
+            return;
+        }
+
+        ASSERT(range.Meshlets != nullptr || range.MeshletCount == 0);
+        MeshletCulling meshletCulling = *culling;
+        meshletCulling.EnableConeCulling = culling->EnableConeCulling && !doubleSided;
+
+        cache.Begin(vertexCount);
+        for (size_t m = 0; m < range.MeshletCount; m++)
+        {
+            const Meshlet& meshlet = range.Meshlets[m];
+            if (!IsMeshletVisible(meshlet, meshletCulling))
+            {
+                continue;
+            }
+
+            const uint32_t* triangles = indices + meshlet.IndexOffset;
+            for (uint32_t i = 0; i < meshlet.TriangleCount * 3; i += 3)
+            {
+                for (int j = 0; j < 3; j++)
+                {
+                    uint32_t index = triangles[i + j];
+                    if (cache.Stamps[index] != cache.DrawId)
+                    {
+                        shade(cache.Varyings[index], index);
+                        cache.Stamps[index] = cache.DrawId;
+                    }
+                }
+                draw(cache.Varyings[triangles[i]], cache.Varyings[triangles[i + 1]], cache.Varyings[triangles[i + 2]]);
+            }
+        }
+    }
+
+    /**
+     * @brief 按实例顺序调用 draw(instance, uniforms)
+     *        程序设置了 InstanceUniforms 时, 逐实例的统一变量在副本上修改, 每次绘制只复制一次
+    */
+    template<typename program_t, typename uniforms_t, typename draw_func_t>
+    static void ForEachInstance(const program_t& program,
+                    const uniforms_t& uniforms,
+                    const InstanceBuffer& instances,
+                    draw_func_t&& draw)
+    {
+        std::optional<uniforms_t> instanceUniforms;
+        if (program.InstanceUniforms)
+        {
+            instanceUniforms.emplace(uniforms);
+        }
+        for (uint32_t instance = 0; instance < (uint32_t)instances.GetCount(); instance++)
+        {
+            if (instanceUniforms)
+            {
+                program.InstanceUniforms(*instanceUniforms, instances, instance);
+                draw(instance, *instanceUniforms);
+            }
+            else
+            {
+                draw(instance, uniforms);
+            }
+        }
+    }
+
+    /**
+     * @brief 着色绘制的公共实现, target 为帧缓存(Program)或几何缓冲(GeometryProgram)
+     * @param shade 顶点着色 shade(out, index), 区分普通与实例化顶点着色器
+    */
+    template<template<typename, typename, typename> typename program_t,
+             typename target_t, typename vertex_t, typename uniforms_t, typename varyings_t, typename shade_func_t>
+    static void DrawRangeShaded(target_t& target,
+                    const program_t<vertex_t, uniforms_t, varyings_t>& program,
+                    const size_t vertexCount,
+                    const IndexRange& range,
+                    const MeshletCulling* culling,
+                    shade_func_t&& shade,
+                    const uniforms_t& uniforms)
+    {
+        static thread_local LazyShadedVertices<varyings_t> cache;
+        DrawTriangles(cache, vertexCount, range, culling, program.EnableDoubleSided, shade,
+            [&](const varyings_t& v0, const varyings_t& v1, const varyings_t& v2)
+            {
+                varyings_t varyings[RGS_MAX_VARYINGS];
+                varyings[0] = v0;
+                varyings[1] = v1;
+                varyings[2] = v2;
+                DrawShaded(target, program, varyings, uniforms);
+            });
+    }
+
+    template<template<typename, typename, typename> typename program_t,
+             typename target_t, typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawRange(target_t& target,
+                    const program_t<vertex_t, uniforms_t, varyings_t>& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const IndexRange& range,
+                    const MeshletCulling* culling,
+                    const uniforms_t& uniforms)
+    {
+        static_assert(std::is_base_of_v<VertexBase, vertex_t>, "vertex_t 必须继承自 RGS::VertexBase");
+        static_assert(std::is_base_of_v<VaryingsBase, varyings_t>, "varyings_t 必须继承自 RGS::VaryingsBase");
+
+        DrawRangeShaded(target, program, vertexCount, range, culling,
+            [&](varyings_t& out, const uint32_t index)
+            {
+                out = varyings_t();
+                program.VertexShader(out, vertices[index], uniforms);
+            }, uniforms);
+    }
+
+    /**
+     * @param cullings 每个实例的剔除参数(各自的模型空间), 为空时按索引绘制
+    */
+    template<template<typename, typename, typename> typename program_t,
+             typename target_t, typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawRangeInstanced(target_t& target,
+                    const program_t<vertex_t, uniforms_t, varyings_t>& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const IndexRange& range,
+                    const InstanceBuffer& instances,
+                    const MeshletCulling* cullings,
+                    const uniforms_t& uniforms)
+    {
+        static_assert(std::is_base_of_v<VertexBase, vertex_t>, "vertex_t 必须继承自 RGS::VertexBase");
+        static_assert(std::is_base_of_v<VaryingsBase, varyings_t>, "varyings_t 必须继承自 RGS::VaryingsBase");
+        ASSERT(program.InstancedVertexShader != nullptr, "实例化绘制需要实例化顶点着色器");
+
+        ForEachInstance(program, uniforms, instances, [&](const uint32_t instance, const uniforms_t& instanceUniforms)
+            {
+                DrawRangeShaded(target, program, vertexCount, range, cullings ? &cullings[instance] : nullptr,
+                    [&](varyings_t& out, const uint32_t index)
+                    {
+                        out = varyings_t();
+                        program.InstancedVertexShader(out, vertices[index], instances, instance, instanceUniforms);
+                    }, instanceUniforms);
+            });
+    }
+
+    /**
+     * @brief 只写深度绘制的公共实现, 只变换顶点位置
+    */
+    template<typename vertex_t>
+    static void DrawDepthRange(Framebuffer& framebuffer,
+                    const DepthProgram& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const IndexRange& range,
+                    const MeshletCulling* culling,
+                    const Mat4& mvp)
+    {
+        static_assert(std::is_base_of_v<VertexBase, vertex_t>, "vertex_t 必须继承自 RGS::VertexBase");
+        ASSERT(framebuffer.GetSampleCount() == 1, "只写深度的绘制不支持多重采样帧缓存");
+
+        static thread_local LazyShadedVertices<Vec4> cache;
+        DrawTriangles(cache, vertexCount, range, culling, program.EnableDoubleSided,
+            [&](Vec4& out, const uint32_t index) { out = mvp * vertices[index].ModelPos; },
+            [&](const Vec4& p0, const Vec4& p1, const Vec4& p2)
+            {
+                VaryingsBase varyings[RGS_MAX_VARYINGS];
+                varyings[0].ClipPos = p0;
+                varyings[1].ClipPos = p1;
+                varyings[2].ClipPos = p2;
+                DrawDepthTransformed(framebuffer, program, varyings);
+            });
+    }
+
+    /**
+     * @param cullings 每个实例的剔除参数, 为空时按索引绘制
+    */
+    template<typename vertex_t>
+    static void DrawDepthRangeInstanced(Framebuffer& framebuffer,
+                    const DepthProgram& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const IndexRange& range,
+                    const InstanceBuffer& instances,
+                    const MeshletCulling* cullings,
+                    const Mat4& viewProj)
+    {
+        for (size_t instance = 0; instance < instances.GetCount(); instance++)
+        {
+            // 每个实例的模型观察投影矩阵只计算一次
+            DrawDepthRange(framebuffer, program, vertices, vertexCount, range, cullings ? &cullings[instance] : nullptr,
+                            viewProj * instances.Models[instance]);
+        }
+    }
+
+public:
+    /**
+     * @brief 绘制
+     * @param framebuffer 帧缓存
+     * @param program 着色器程序
+     * @param triangle 三角形
+     * @param uniforms 统一变量
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void Draw(Framebuffer& framebuffer,
+                    const Program<vertex_t, uniforms_t, varyings_t>& program,
+                    const Triangle<vertex_t>& triangle,
+                    const uniforms_t& uniforms)
+    {
+        static_assert(std::is_base_of_v<VertexBase, vertex_t>, "vertex_t 必须继承自 RGS::VertexBase");
+        static_assert(std::is_base_of_v<VaryingsBase, varyings_t>, "varyings_t 必须继承自 RGS::VaryingsBase");
+
+        /* Vertex Shading */
+        varyings_t varyings[RGS_MAX_VARYINGS];
+        for (int i = 0; i < 3; i++)
+        {
+            program.VertexShader(varyings[i], triangle[i], uniforms);
+        }
+
+        DrawShaded(framebuffer, program, varyings, uniforms);
+    }
+
+    /**
+     * @brief 索引绘制, 每个顶点只执行一次顶点着色
+     * @param vertices 顶点缓冲
+     * @param vertexCount 顶点数目
+     * @param indices 索引缓冲, 每 3 个索引为一个三角形
+     * @param indexCount 索引数目
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void Draw(Framebuffer& framebuffer,
+                    const Program<vertex_t, uniforms_t, varyings_t>& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const size_t indexCount,
+                    const uniforms_t& uniforms)
+    {
+        DrawRange(framebuffer, program, vertices, vertexCount, { indices, indexCount, nullptr, 0 }, nullptr, uniforms);
+    }
+
+    /**
+     * @brief 按网格簇绘制: 先整簇剔除, 只对可见簇引用的顶点执行顶点着色
+     * @param meshlets 网格簇, 其索引位置指向 indices
+     * @param meshletCount 网格簇数目
+     * @param culling 剔除参数
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void Draw(Framebuffer& framebuffer,
+                    const Program<vertex_t, uniforms_t, varyings_t>& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const Meshlet* meshlets,
+                    const size_t meshletCount,
+                    const MeshletCulling& culling,
+                    const uniforms_t& uniforms)
+    {
+        DrawRange(framebuffer, program, vertices, vertexCount, { indices, 0, meshlets, meshletCount }, &culling, uniforms);
+    }
+
+    /**
+     * @brief 实例化索引绘制: 同一网格按实例缓冲绘制多次, 顶点着色器从 instances 读取逐实例数据
+     *        顶点与索引缓冲、统一变量和着色结果缓冲在所有实例间共享, 不需要为每个实例复制统一变量
+     * @param instances 实例缓冲, 实例按顺序绘制
+     * @param uniforms 所有实例共享的统一变量
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawInstanced(Framebuffer& framebuffer,
+                    const Program<vertex_t, uniforms_t, varyings_t>& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const size_t indexCount,
+                    const InstanceBuffer& instances,
+                    const uniforms_t& uniforms)
+    {
+        DrawRangeInstanced(framebuffer, program, vertices, vertexCount, { indices, indexCount, nullptr, 0 }, instances, nullptr, uniforms);
+    }
+
+    /**
+     * @brief 实例化网格簇绘制: 每个实例先整簇剔除, 只对可见簇引用的顶点执行实例化顶点着色
+     * @param meshlets 网格簇, 其索引位置指向 indices
+     * @param meshletCount 网格簇数目
+     * @param cullings 每个实例的剔除参数(各自的模型空间), 数目与实例数一致
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawInstanced(Framebuffer& framebuffer,
+                    const Program<vertex_t, uniforms_t, varyings_t>& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const Meshlet* meshlets,
+                    const size_t meshletCount,
+                    const InstanceBuffer& instances,
+                    const MeshletCulling* cullings,
+                    const uniforms_t& uniforms)
+    {
+        DrawRangeInstanced(framebuffer, program, vertices, vertexCount, { indices, 0, meshlets, meshletCount }, instances, cullings, uniforms);
+    }
+
+    /**
+     * @brief 延迟渲染几何阶段, 将表面信息写入几何缓冲
+     * @param gbuffer 几何缓冲
+     * @param program 几何着色器程序
+     * @param triangle 三角形
+     * @param uniforms 统一变量
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawGeometry(GBuffer& gbuffer,
+                    const GeometryProgram<vertex_t, uniforms_t, varyings_t>& program,
+                    const Triangle<vertex_t>& triangle,
+                    const uniforms_t& uniforms)
+    {
+        static_assert(std::is_base_of_v<VertexBase, vertex_t>, "vertex_t 必须继承自 RGS::VertexBase");
+        static_assert(std::is_base_of_v<VaryingsBase, varyings_t>, "varyings_t 必须继承自 RGS::VaryingsBase");
+
+        /* Vertex Shading */
+        varyings_t varyings[RGS_MAX_VARYINGS];
+        for (int i = 0; i < 3; i++)
+        {
+            program.VertexShader(varyings[i], triangle[i], uniforms);
+        }
+
+        DrawShaded(gbuffer, program, varyings, uniforms);
+    }
+
+    /**
+     * @brief 延迟渲染几何阶段的索引绘制
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawGeometry(GBuffer& gbuffer,
+                    const GeometryProgram<vertex_t, uniforms_t, varyings_t>& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const size_t indexCount,
+                    const uniforms_t& uniforms)
+    {
+        DrawRange(gbuffer, program, vertices, vertexCount, { indices, indexCount, nullptr, 0 }, nullptr, uniforms);
+    }
+
+    /**
+     * @brief 延迟渲染几何阶段的网格簇绘制
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawGeometry(GBuffer& gbuffer,
+                    const GeometryProgram<vertex_t, uniforms_t, varyings_t>& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const Meshlet* meshlets,
+                    const size_t meshletCount,
+                    const MeshletCulling& culling,
+                    const uniforms_t& uniforms)
+    {
+        DrawRange(gbuffer, program, vertices, vertexCount, { indices, 0, meshlets, meshletCount }, &culling, uniforms);
+    }
+
+    /**
+     * @brief 延迟渲染几何阶段的实例化索引绘制
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawGeometryInstanced(GBuffer& gbuffer,
+                    const GeometryProgram<vertex_t, uniforms_t, varyings_t>& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const size_t indexCount,
+                    const InstanceBuffer& instances,
+                    const uniforms_t& uniforms)
+    {
+        DrawRangeInstanced(gbuffer, program, vertices, vertexCount, { indices, indexCount, nullptr, 0 }, instances, nullptr, uniforms);
+    }
+
+    /**
+     * @brief 延迟渲染几何阶段的实例化网格簇绘制
+    */
+    template<typename vertex_t, typename uniforms_t, typename varyings_t>
+    static void DrawGeometryInstanced(GBuffer& gbuffer,
+                    const GeometryProgram<vertex_t, uniforms_t, varyings_t>& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const Meshlet* meshlets,
+                    const size_t meshletCount,
+                    const InstanceBuffer& instances,
+                    const MeshletCulling* cullings,
+                    const uniforms_t& uniforms)
+    {
+        DrawRangeInstanced(gbuffer, program, vertices, vertexCount, { indices, 0, meshlets, meshletCount }, instances, cullings, uniforms);
+    }
+
+    /**
+     * @brief 只写深度的绘制, 仅变换顶点位置, 不执行着色器也不写入颜色
+     * @param framebuffer 帧缓存(只使用深度缓冲)
+     * @param program 深度绘制状态
+     * @param triangle 三角形
+     * @param mvp 模型观察投影矩阵(生成阴影贴图时为光源空间矩阵)
+    */
+    template<typename vertex_t>
+    static void DrawDepth(Framebuffer& framebuffer,
+                    const DepthProgram& program,
+                    const Triangle<vertex_t>& triangle,
+                    const Mat4& mvp)
+    {
+        static_assert(std::is_base_of_v<VertexBase, vertex_t>, "vertex_t 必须继承自 RGS::VertexBase");
+        ASSERT(framebuffer.GetSampleCount() == 1, "只写深度的绘制不支持多重采样帧缓存");
+
+        /* Vertex Transform */
+        VaryingsBase varyings[RGS_MAX_VARYINGS];
+        for (int i = 0; i < 3; i++)
+        {
+            varyings[i].ClipPos = mvp * triangle[i].ModelPos;
+        }
+
+        DrawDepthTransformed(framebuffer, program, varyings);
+    }
+
+    /**
+     * @brief 只写深度的索引绘制, 每个顶点只变换一次
+    */
+    template<typename vertex_t>
+    static void DrawDepth(Framebuffer& framebuffer,
+                    const DepthProgram& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const size_t indexCount,
+                    const Mat4& mvp)
+    {
+        DrawDepthRange(framebuffer, program, vertices, vertexCount, { indices, indexCount, nullptr, 0 }, nullptr, mvp);
+    }
+
+    /**
+     * @brief 只写深度的网格簇绘制, 只变换可见簇引用的顶点
+    */
+    template<typename vertex_t>
+    static void DrawDepth(Framebuffer& framebuffer,
+                    const DepthProgram& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const Meshlet* meshlets,
+                    const size_t meshletCount,
+                    const MeshletCulling& culling,
+                    const Mat4& mvp)
+    {
+        DrawDepthRange(framebuffer, program, vertices, vertexCount, { indices, 0, meshlets, meshletCount }, &culling, mvp);
+    }
+
+    /**
+     * @brief 只写深度的实例化索引绘制, 每个实例的模型观察投影矩阵只计算一次
+     * @param instances 实例缓冲, 只使用模型矩阵
+     * @param viewProj 观察投影矩阵(生成阴影贴图时为光源空间矩阵)
+    */
+    template<typename vertex_t>
+    static void DrawDepthInstanced(Framebuffer& framebuffer,
+                    const DepthProgram& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const size_t indexCount,
+                    const InstanceBuffer& instances,
+                    const Mat4& viewProj)
+    {
+        DrawDepthRangeInstanced(framebuffer, program, vertices, vertexCount, { indices, indexCount, nullptr, 0 }, instances, nullptr, viewProj);
+    }
+
+    /**
+     * @brief 只写深度的实例化网格簇绘制, 每个实例只变换其可见簇引用的顶点
+     * @param cullings 每个实例的剔除参数(各自的模型空间), 数目与实例数一致
+    */
+    template<typename vertex_t>
+    static void DrawDepthInstanced(Framebuffer& framebuffer,
+                    const DepthProgram& program,
+                    const vertex_t* vertices,
+                    const size_t vertexCount,
+                    const uint32_t* indices,
+                    const Meshlet* meshlets,
+                    const size_t meshletCount,
+                    const InstanceBuffer& instances,
+                    const MeshletCulling* cullings,
+                    const Mat4& viewProj)
+    {
+        DrawDepthRangeInstanced(framebuffer, program, vertices, vertexCount, { indices, 0, meshlets, meshletCount }, instances, cullings, viewProj);
+    }
 };
 
 }
\ No newline at end of file
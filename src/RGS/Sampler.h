@@ -0,0 +1,32 @@
+#pragma once
+
+namespace RGS {
+
+enum class TextureFilter
+{
+    NEAREST,        // 最近点采样
+    BILINEAR,       // 双线性过滤(只使用原始纹理)
+    TRILINEAR,      // 三线性过滤(需要 mipmap 与纹理坐标导数, 无导数时退化为双线性)
+};
+
+enum class WrapMode
+{
+    REPEAT,         // 重复
+    MIRROR,         // 镜像重复
+    CLAMP,          // 取边界纹素
+};
+
+// 采样器状态, 与纹理分离, 同一纹理可以用不同的采样方式采样
+struct Sampler
+{
+    TextureFilter Filter = TextureFilter::TRILINEAR;    // 过滤方式
+    WrapMode WrapU = WrapMode::REPEAT;                  // U 方向超出 [0, 1] 时的处理方式
+    WrapMode WrapV = WrapMode::REPEAT;                  // V 方向超出 [0, 1] 时的处理方式
+    float LodBias = 0.0f;                               // 三线性过滤时 mipmap 层级的偏移
+
+    Sampler() = default;
+    Sampler(const TextureFilter filter, const WrapMode wrap)
+        : Filter(filter), WrapU(wrap), WrapV(wrap) {}
+};
+
+}
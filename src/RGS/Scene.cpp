@@ -0,0 +1,85 @@
+#include "Base.h"
+#include "Scene.h"
+
+#include <utility>
+
+namespace RGS {
+
+namespace {
+
+AABB GetWorldBounds(const Mesh& mesh, const Mat4& transform)
+{
+    return TransformAABB({ mesh.GetBoundsMin(), mesh.GetBoundsMax() }, transform);
+}
+
+}
+
+Scene::Scene(const float bvhMargin)
+    : m_Bvh(bvhMargin)
+{
+}
+
+uint32_t Scene::AddMaterial(const Material& material)
+{
+    m_Materials.push_back(material);
+    return (uint32_t)m_Materials.size() - 1;
+}
+
+ObjectId Scene::AddObject(std::shared_ptr<Mesh> mesh, const uint32_t materialIndex, const Mat4& transform)
+{
+    ASSERT(mesh, "物体必须有网格");
+    ASSERT(materialIndex < m_Materials.size());
+
+    ObjectId id;
+    if (m_FreeObjects.empty())
+    {
+        id = (ObjectId)m_Objects.size();
+        m_Objects.emplace_back();
+    }
+    else
+    {
+        id = m_FreeObjects.back();
+        m_FreeObjects.pop_back();
+    }
+
+    SceneObject& object = m_Objects[id];
+    object.ObjectMesh = std::move(mesh);
+    object.MaterialIndex = materialIndex;
+    object.Transform = transform;
+    object.NormalTransform = Mat4NormalMatrix(transform);
+    object.WorldBounds = GetWorldBounds(*object.ObjectMesh, transform);
+    object.BvhLeaf = m_Bvh.Insert(object.WorldBounds, id);
+    return id;
+}
+
+void Scene::RemoveObject(const ObjectId id)
+{
+    ASSERT(id < m_Objects.size() && m_Objects[id].ObjectMesh, "物体不存在");
+    m_Bvh.Remove(m_Objects[id].BvhLeaf);
+    m_Objects[id] = SceneObject();
+    m_FreeObjects.push_back(id);
+}
+
+void Scene::SetTransform(const ObjectId id, const Mat4& transform)
+{
+    ASSERT(id < m_Objects.size() && m_Objects[id].ObjectMesh, "物体不存在");
+    SceneObject& object = m_Objects[id];
+    object.Transform = transform;
+    object.NormalTransform = Mat4NormalMatrix(transform);
+    object.WorldBounds = GetWorldBounds(*object.ObjectMesh, transform);
+    m_Bvh.Refit(object.BvhLeaf, object.WorldBounds);
+}
+
+void Scene::Cull(const Mat4& viewProj, std::vector<ObjectId>& visible) const
+{
+    visible.clear();
+    const Frustum frustum(viewProj);
+    m_Bvh.Query(frustum, [&](const uint32_t id, const bool fullyInside)
+        {
+            // 叶节点保存的是扩大后的包围盒, 与视锥边界相交时再用精确包围盒测试
+            if (fullyInside || frustum.Test(m_Objects[id].WorldBounds) != FrustumTestResult::OUTSIDE)
+                visible.push_back(id);
+        });
+}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "RGS/AssetCache.h"
+#include "RGS/Bvh.h"
+#include "RGS/Frustum.h"
+#include "RGS/Maths.h"
+#include "RGS/Mesh.h"
+#include "RGS/TextureAtlas.h"
+#include "RGS/VirtualTexture.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace RGS {
+
+// 材质: 物体共享的纹理与着色参数
+struct Material
+{
+    TextureHandle Diffuse;
+    TextureHandle Specular;
+    TextureHandle Interleaved;                  // 交错存储的材质纹理, 供 BlinnMaterialFragmentShader 使用
+    const TextureAtlas* Atlas = nullptr;        // 非空时改用图集条目 AtlasEntry(第 0 层漫反射, 第 1 层镜面反射), 纹理坐标映射到条目区域
+    int AtlasEntry = -1;
+    const VirtualTexture* VirtualDiffuse = nullptr; // 非空时漫反射颜色改从虚拟纹理采样
+    Vec3 Color { 1.0f, 1.0f, 1.0f };
+    float Shininess = 32.0f;
+};
+
+using ObjectId = uint32_t;
+
+// 场景中的物体实例
+struct SceneObject
+{
+    std::shared_ptr<Mesh> ObjectMesh;           // 为空表示该编号未被使用
+    uint32_t MaterialIndex = 0;
+    Mat4 Transform;                             // 模型矩阵
+    Mat4 NormalTransform;                       // 法线矩阵, 见 Mat4NormalMatrix
+    AABB WorldBounds;                           // 世界空间包围盒
+    int BvhLeaf = Bvh::INVALID_NODE;
+};
+
+// 场景: 物体实例与材质, 物体的世界包围盒由动态 BVH 索引, 每帧先做视锥剔除, 只有可能可见的物体交给渲染器
+class Scene
+{
+public:
+    /**
+     * @param bvhMargin BVH 叶节点包围盒的扩大距离, 物体移动不超过该距离时不需要更新 BVH
+    */
+    explicit Scene(const float bvhMargin = 0.1f);
+
+    uint32_t AddMaterial(const Material& material);
+    const Material& GetMaterial(const uint32_t index) const { return m_Materials[index]; }
+    size_t GetMaterialCount() const { return m_Materials.size(); }
+
+    /**
+     * @brief 添加物体, 世界包围盒由网格包围盒变换得到
+     * @return 物体编号, 在删除前保持不变, 删除后可能被新物体复用
+    */
+    ObjectId AddObject(std::shared_ptr<Mesh> mesh, const uint32_t materialIndex, const Mat4& transform);
+    void RemoveObject(const ObjectId id);
+    /**
+     * @brief 移动物体: 更新模型矩阵与世界包围盒, 并重新拟合 BVH
+    */
+    void SetTransform(const ObjectId id, const Mat4& transform);
+
+    const SceneObject& GetSceneObject(const ObjectId id) const { return m_Objects[id]; }     // 不命名为 GetObject, 以免与 Windows.h 的宏冲突
+    size_t GetObjectCount() const { return m_Objects.size() - m_FreeObjects.size(); }
+    const Bvh& GetBvh() const { return m_Bvh; }
+
+    /**
+     * @brief 视锥剔除, 按 BVH 遍历顺序输出世界包围盒与视锥相交的物体
+     * @param viewProj 观察投影矩阵
+     * @param visible 输出的物体编号, 先被清空
+    */
+    void Cull(const Mat4& viewProj, std::vector<ObjectId>& visible) const;
+
+private:
+    std::vector<SceneObject> m_Objects;
+    std::vector<ObjectId> m_FreeObjects;
+    std::vector<Material> m_Materials;
+    Bvh m_Bvh;
+};
+
+}
@@ -5,28 +5,108 @@
 
 namespace RGS {
 
+namespace {
+
+Vec2 RemapTexCoord(const Vec2& texCoord, const Vec4& region)
+{
+    return { region.X + texCoord.X * region.Z, region.Y + texCoord.Y * region.W };
+}
+
+}
+
 void BlinnVertexShader(BlinnVaryings& varyings, const BlinnVertex& vertex, const BlinnUniforms& uniforms)
 {
     varyings.ClipPos = uniforms.MVP * vertex.ModelPos;                                              // 计算顶点的裁剪空间位置     
-    varyings.TexCoord = vertex.TexCoord;                                                            // 传递顶点的纹理坐标   
+    varyings.TexCoord = RemapTexCoord(vertex.TexCoord, uniforms.TexCoordRegion);                   // 传递顶点的纹理坐标(映射到图集区域)
     varyings.WorldPos = uniforms.Model * vertex.ModelPos;                                           // 计算顶点的世界空间位置
     varyings.WorldNormal = uniforms.ModelNormalToWorld * Vec4{ vertex.ModelNormal, 0.0f };  // 计算顶点的世界空间法线，并将其转换为 Vec4 类型以便矩阵运算
 }
 
-Vec4 BlinnFragmentShader(bool& discard, const BlinnVaryings& varyings, const BlinnUniforms& uniforms)
+void BlinnInstancedVertexShader(BlinnVaryings& varyings, const BlinnVertex& vertex, const InstanceBuffer& instances, const uint32_t instance, const BlinnUniforms& uniforms)
 {
-    discard = false;
+    Vec4 worldPos = instances.Models[instance] * vertex.ModelPos;
+    varyings.ClipPos = uniforms.ViewProj * worldPos;
+    varyings.TexCoord = RemapTexCoord(vertex.TexCoord, instances.TexCoordRegions[instance]);
+    varyings.WorldPos = worldPos;
+    varyings.WorldNormal = instances.NormalMatrices[instance] * Vec4{ vertex.ModelNormal, 0.0f };
+}
+
+void BlinnInstanceUniforms(BlinnUniforms& uniforms, const InstanceBuffer& instances, const uint32_t instance)
+{
+    uniforms.ObjectColor = instances.Colors[instance];
+}
+
+Vec3 BlinnLighting(const Light& light,
+                    const Vec3& worldPos,
+                    const Vec3& worldNormal,
+                    const Vec3& viewDir,
+                    const Vec3& diffColor,
+                    const Vec3& specularStrength,
+                    const float shininess)
+{
+    Vec3 toLight = light.Pos - worldPos;
+    float distance = (float)std::sqrt(Dot(toLight, toLight));
+    float attenuation = GetLightAttenuation(light, distance);
+    if (attenuation <= 0.0f)
+        return { 0.0f, 0.0f, 0.0f };
+
+    // 计算光源方向和半角方向
+    Vec3 lightDir = toLight / distance;
+    attenuation *= GetSpotIntensity(light, lightDir);
+    if (attenuation <= 0.0f)
+        return { 0.0f, 0.0f, 0.0f };
+    Vec3 halfDir = Normalize(lightDir + viewDir);
+
+    // 计算漫反射光
+    Vec3 diffuse = std::max(0.0f, Dot(worldNormal, lightDir)) * light.Diffuse * diffColor;
+    // 计算镜面反射光
+    Vec3 specular = (float)pow(std::max(0.0f, Dot(halfDir, worldNormal)), shininess) * light.Specular * specularStrength;
+
+    return attenuation * (diffuse + specular);
+}
+
+namespace {
 
-    // 获取相机位置、光源位置和世界位置
+/**
+ * @brief 累加环境光与各光源的光照
+*/
+Vec3 BlinnShade(const BlinnVaryings& varyings, const BlinnUniforms& uniforms, const Vec3& ambient, const Vec3& diffColor, const Vec3& specularStrength)
+{
+    // 获取相机位置和世界位置
     const Vec3& cameraPos = uniforms.CameraPos;
-    const Vec3& lightPos = uniforms.LightPos;
     const Vec3& worldPos = varyings.WorldPos;
-    // 计算法线、视图方向和光源方向
+    // 计算法线、视图方向
     Vec3 worldNormal = Normalize(varyings.WorldNormal);
     Vec3 viewDir = Normalize(cameraPos - worldPos);
-    Vec3 lightDir = Normalize(lightPos - worldPos);
-    // 计算半角方向
-    Vec3 halfDir = Normalize(lightDir + viewDir);
+
+    // 累加各光源的光照
+    Vec3 result = ambient;
+    if (uniforms.Grid)
+    {
+        // Forward+: 只遍历像素所在屏幕块的光源
+        int lightNum = 0;
+        const uint32_t* lightIndices = uniforms.Grid->GetTileLights((int)varyings.FragPos.X, (int)varyings.FragPos.Y, lightNum);
+        for (int i = 0; i < lightNum; i++)
+        {
+            const Light& light = uniforms.Lights[lightIndices[i]];
+            result = result + BlinnLighting(light, worldPos, worldNormal, viewDir, diffColor, specularStrength, uniforms.Shininess);
+        }
+    }
+    else
+    {
+        for (const Light& light : uniforms.Lights)
+        {
+            result = result + BlinnLighting(light, worldPos, worldNormal, viewDir, diffColor, specularStrength, uniforms.Shininess);
+        }
+    }
+    return result;
+}
+
+}
+
+Vec4 BlinnFragmentShader(bool& discard, const BlinnVaryings& varyings, const BlinnVaryings& ddx, const BlinnVaryings& ddy, const BlinnUniforms& uniforms)
+{
+    discard = false;
 
     // 获取环境光颜色
     Vec3 ambient = uniforms.LightAmbient;
@@ -35,19 +115,51 @@ Vec4 BlinnFragmentShader(bool& discard, const BlinnVaryings& varyings, const Bli
     if (uniforms.Diffuse && uniforms.Specular)
     {
         const Vec2& texCoord = varyings.TexCoord; 
-        diffColor = uniforms.Diffuse->Sample(texCoord);
+        diffColor = uniforms.Diffuse->Sample(uniforms.TextureSampler, texCoord, ddx.TexCoord, ddy.TexCoord);
         ambient = ambient * diffColor;
-        specularStrength = uniforms.Specular->Sample(texCoord);
+        specularStrength = uniforms.Specular->Sample(uniforms.TextureSampler, texCoord, ddx.TexCoord, ddy.TexCoord);
+    }
+    if (uniforms.VirtualDiffuse)
+    {
+        diffColor = uniforms.VirtualDiffuse->Sample(uniforms.TextureSampler, varyings.TexCoord, ddx.TexCoord, ddy.TexCoord);
+        ambient = uniforms.LightAmbient * diffColor;
     }
-    // 计算漫反射光
-    Vec3 diffuse = std::max(0.0f, Dot(worldNormal, lightDir)) * uniforms.LightDiffuse * diffColor;
-    // 计算镜面反射光
-    Vec3 specular = (float)pow(std::max(0.0f, Dot(halfDir, worldNormal)), uniforms.Shininess) * uniforms.LightSpecular * specularStrength;
 
-    // 计算最终光照颜色
-    Vec3 result = ambient + diffuse + specular;
+    diffColor = diffColor * uniforms.ObjectColor;
+    ambient = ambient * uniforms.ObjectColor;
+    return { BlinnShade(varyings, uniforms, ambient, diffColor, specularStrength), 1.0f };
+}
+
+Vec4 BlinnMaterialFragmentShader(bool& discard, const BlinnVaryings& varyings, const BlinnVaryings& ddx, const BlinnVaryings& ddy, const BlinnUniforms& uniforms)
+{
+    discard = false;
 
-    return { result, 1.0f };
+    Vec3 ambient = uniforms.LightAmbient;
+    Vec3 specularStrength { 1.0f, 1.0f, 1.0f };
+    Vec3 diffColor { 1.0f, 1.0f, 1.0f };
+    if (uniforms.Material)
+    {
+        // 一次采样同时得到漫反射颜色与镜面反射强度
+        Vec4 material = uniforms.Material->Sample(uniforms.TextureSampler, varyings.TexCoord, ddx.TexCoord, ddy.TexCoord);
+        diffColor = material;
+        ambient = ambient * diffColor;
+        specularStrength = { material.W, material.W, material.W };
+    }
+    else if (uniforms.Diffuse && uniforms.Specular)
+    {
+        diffColor = uniforms.Diffuse->Sample(uniforms.TextureSampler, varyings.TexCoord, ddx.TexCoord, ddy.TexCoord);
+        ambient = ambient * diffColor;
+        specularStrength = uniforms.Specular->Sample(uniforms.TextureSampler, varyings.TexCoord, ddx.TexCoord, ddy.TexCoord);
+    }
+    if (uniforms.VirtualDiffuse)
+    {
+        diffColor = uniforms.VirtualDiffuse->Sample(uniforms.TextureSampler, varyings.TexCoord, ddx.TexCoord, ddy.TexCoord);
+        ambient = uniforms.LightAmbient * diffColor;
+    }
+
+    diffColor = diffColor * uniforms.ObjectColor;
+    ambient = ambient * uniforms.ObjectColor;
+    return { BlinnShade(varyings, uniforms, ambient, diffColor, specularStrength), 1.0f };
 }
 
-} 
\ No newline at end of file
+}
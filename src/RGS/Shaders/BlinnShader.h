@@ -2,9 +2,13 @@
 
 #include "ShaderBase.h"
 
+#include "RGS/Light.h"
+#include "RGS/LightGrid.h"
 #include "RGS/Texture.h"
+#include "RGS/VirtualTexture.h"
 #include "RGS/Maths.h"
 #include <ostream>
+#include <vector>
 
 namespace RGS {
 
@@ -33,23 +37,58 @@ struct BlinnUniforms : public UniformsBase
 {
     Mat4 Model;                                         // 模型变换矩阵
     Mat4 ModelNormalToWorld;                            // 模型法线变换到世界空间的矩阵
-    Vec3 LightPos { 0.0f, 1.0f, 2.0f };         // 光源位置
+    Mat4 ViewProj;                                      // 观察投影矩阵, 实例化绘制时与逐实例模型矩阵相乘
+    std::vector<Light> Lights { Light() };              // 光源列表
+    const LightGrid* Grid = nullptr;                    // 分块光源列表, 非空时只计算像素所在块的光源(Forward+)
     Vec3 LightAmbient { 0.3f, 0.3f, 0.3f };     // 环境光颜色
-    Vec3 LightDiffuse { 0.5f, 0.5f, 0.5f };     // 漫反射光颜色
-    Vec3 LightSpecular { 1.0f, 1.0f, 1.0f };    // 镜面反射光颜色
-    Vec3 ObjectColor { 1.0f, 1.0f, 1.0f };      // 物体颜色
+    Vec3 ObjectColor { 1.0f, 1.0f, 1.0f };      // 物体颜色, 与漫反射颜色相乘(实例化绘制时由 BlinnInstanceUniforms 逐实例设置)
     Vec3 CameraPos;                                     // 相机位置
     float Shininess = 32.0f;                            // 物体的镜面指数
+    Vec4 TexCoordRegion { 0.0f, 0.0f, 1.0f, 1.0f };     // 纹理坐标变换(图集区域), 纹理坐标 = XY + 原纹理坐标 * ZW, 实例化绘制时改用实例缓冲中的值
 
-    Texture* Diffuse = nullptr;
-    Texture* Specular = nullptr;
+    const Texture* Diffuse = nullptr;
+    const Texture* Specular = nullptr;
+    const Texture* Material = nullptr;                  // 交错存储的材质纹理(RGB 漫反射, A 镜面反射强度), 供 BlinnMaterialFragmentShader 使用
+    const VirtualTexture* VirtualDiffuse = nullptr;     // 非空时漫反射颜色改从虚拟纹理采样(同时记录页反馈), 镜面反射强度不变
+    Sampler TextureSampler;                             // 漫反射与镜面反射纹理的采样器
 };
 
+/**
+ * @brief 计算单个光源的 Blinn-Phong 漫反射与镜面反射光照(不含环境光)
+ * @param light 光源
+ * @param worldPos 片段世界坐标
+ * @param worldNormal 片段世界法线(已归一化)
+ * @param viewDir 片段指向相机的方向(已归一化)
+ * @param diffColor 漫反射颜色
+ * @param specularStrength 镜面反射强度
+ * @param shininess 镜面指数
+*/
+Vec3 BlinnLighting(const Light& light,
+                    const Vec3& worldPos,
+                    const Vec3& worldNormal,
+                    const Vec3& viewDir,
+                    const Vec3& diffColor,
+                    const Vec3& specularStrength,
+                    const float shininess);
+
 void BlinnVertexShader(BlinnVaryings& varyings, const BlinnVertex& vertex, const BlinnUniforms& uniforms);
+/**
+ * @brief Blinn实例化顶点着色器, 模型矩阵与法线矩阵从实例缓冲读取, 使用 uniforms.ViewProj 而不是 uniforms.MVP
+*/
+void BlinnInstancedVertexShader(BlinnVaryings& varyings, const BlinnVertex& vertex, const InstanceBuffer& instances, const uint32_t instance, const BlinnUniforms& uniforms);
+/**
+ * @brief 实例化绘制时逐实例设置片段阶段使用的统一变量(实例颜色), 颜色在三角形内不变, 不作为插值变量
+*/
+void BlinnInstanceUniforms(BlinnUniforms& uniforms, const InstanceBuffer& instances, const uint32_t instance);
 
 /**
  * @brief Blinn片段着色器
 */
-Vec4 BlinnFragmentShader(bool& discard, const BlinnVaryings& varyings, const BlinnUniforms& uniforms);
+Vec4 BlinnFragmentShader(bool& discard, const BlinnVaryings& varyings, const BlinnVaryings& ddx, const BlinnVaryings& ddy, const BlinnUniforms& uniforms);
+/**
+ * @brief 使用交错材质纹理的 Blinn 片段着色器, 每个像素只采样一次 uniforms.Material;
+ *        uniforms.Material 为空时(如图集材质)退回分别采样漫反射与镜面反射纹理
+*/
+Vec4 BlinnMaterialFragmentShader(bool& discard, const BlinnVaryings& varyings, const BlinnVaryings& ddx, const BlinnVaryings& ddy, const BlinnUniforms& uniforms);
 
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "DeferredShader.h"
+#include "RGS/Base.h"
+#include "RGS/Maths.h"
+
+namespace RGS {
+
+void BlinnGeometryShader(bool& discard, GBufferTexel& texel, const BlinnVaryings& varyings, const BlinnVaryings& ddx, const BlinnVaryings& ddy, const BlinnUniforms& uniforms)
+{
+    discard = false;
+
+    texel.WorldPos = varyings.WorldPos;
+    texel.Normal = Normalize(varyings.WorldNormal);
+    texel.Albedo = { 1.0f, 1.0f, 1.0f };
+    texel.SpecularStrength = { 1.0f, 1.0f, 1.0f };
+    if (uniforms.Material)
+    {
+        Vec4 material = uniforms.Material->Sample(uniforms.TextureSampler, varyings.TexCoord, ddx.TexCoord, ddy.TexCoord);
+        texel.Albedo = material;
+        texel.SpecularStrength = { material.W, material.W, material.W };
+    }
+    else if (uniforms.Diffuse && uniforms.Specular)
+    {
+        const Vec2& texCoord = varyings.TexCoord;
+        texel.Albedo = uniforms.Diffuse->Sample(uniforms.TextureSampler, texCoord, ddx.TexCoord, ddy.TexCoord);
+        texel.SpecularStrength = uniforms.Specular->Sample(uniforms.TextureSampler, texCoord, ddx.TexCoord, ddy.TexCoord);
+    }
+    if (uniforms.VirtualDiffuse)
+        texel.Albedo = uniforms.VirtualDiffuse->Sample(uniforms.TextureSampler, varyings.TexCoord, ddx.TexCoord, ddy.TexCoord);
+    texel.Albedo = texel.Albedo * uniforms.ObjectColor;
+}
+
+void BlinnLightingPass(Framebuffer& framebuffer, const GBuffer& gbuffer, const DeferredLightingUniforms& uniforms)
+{
+    const int width = gbuffer.GetWidth();
+    const int height = gbuffer.GetHeight();
+    ASSERT(framebuffer.GetWidth() == width && framebuffer.GetHeight() == height);
+
+    /* Ambient (环境光, 同时初始化被几何覆盖的像素) */
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            if (gbuffer.GetDepth(x, y) >= 1.0f)     // 未被几何覆盖
+                continue;
+            framebuffer.SetColor(x, y, uniforms.LightAmbient * gbuffer.GetTexel(x, y).Albedo);
+        }
+    }
+
+    /* Light Accumulation (逐光源累加, 只遍历光源的屏幕范围) */
+    for (const Light& light : uniforms.Lights)
+    {
+        ScreenRect rect;
+        if (!GetLightScreenRect(rect, light, uniforms.ViewProj, width, height))
+            continue;
+
+        for (int y = rect.MinY; y <= rect.MaxY; y++)
+        {
+            for (int x = rect.MinX; x <= rect.MaxX; x++)
+            {
+                if (gbuffer.GetDepth(x, y) >= 1.0f)
+                    continue;
+
+                const GBufferTexel& texel = gbuffer.GetTexel(x, y);
+                Vec3 viewDir = Normalize(uniforms.CameraPos - texel.WorldPos);
+                Vec3 color = BlinnLighting(light, texel.WorldPos, texel.Normal, viewDir,
+                                            texel.Albedo, texel.SpecularStrength, uniforms.Shininess);
+                framebuffer.SetColor(x, y, framebuffer.GetColor(x, y) + color);
+            }
+        }
+    }
+
+    /* Resolve (限制颜色范围) */
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            if (gbuffer.GetDepth(x, y) >= 1.0f)
+                continue;
+            Vec3 color = framebuffer.GetColor(x, y);
+            color.X = Clamp(color.X, 0.0f, 1.0f);
+            color.Y = Clamp(color.Y, 0.0f, 1.0f);
+            color.Z = Clamp(color.Z, 0.0f, 1.0f);
+            framebuffer.SetColor(x, y, color);
+        }
+    }
+}
+
+}
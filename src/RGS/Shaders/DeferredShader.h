@@ -0,0 +1,36 @@
+#pragma once
+
+#include "BlinnShader.h"
+
+#include "RGS/Framebuffer.h"
+#include "RGS/GBuffer.h"
+#include "RGS/Light.h"
+#include "RGS/Maths.h"
+#include <vector>
+
+namespace RGS {
+
+struct DeferredLightingUniforms
+{
+    Mat4 ViewProj;                                      // 观察投影矩阵, 用于计算光源的屏幕范围
+    Vec3 CameraPos;                                     // 相机位置
+    Vec3 LightAmbient { 0.3f, 0.3f, 0.3f };     // 环境光颜色
+    float Shininess = 32.0f;                            // 物体的镜面指数
+
+    std::vector<Light> Lights;                          // 光源列表
+};
+
+/**
+ * @brief Blinn几何片段着色器, 将表面信息写入几何缓冲
+*/
+void BlinnGeometryShader(bool& discard, GBufferTexel& texel, const BlinnVaryings& varyings, const BlinnVaryings& ddx, const BlinnVaryings& ddy, const BlinnUniforms& uniforms);
+
+/**
+ * @brief 延迟光照阶段, 每个光源只处理其屏幕范围内被几何覆盖的像素
+ * @param framebuffer 输出帧缓存
+ * @param gbuffer 几何缓冲
+ * @param uniforms 光照参数
+*/
+void BlinnLightingPass(Framebuffer& framebuffer, const GBuffer& gbuffer, const DeferredLightingUniforms& uniforms);
+
+}
@@ -1,7 +1,9 @@
 #pragma once
 #include "RGS/Maths.h"
+#include <cstddef>
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace RGS {
 
@@ -29,4 +31,36 @@ namespace RGS {
         operator const std::string() const { return (std::string)MVP; }
     };
 
+    /**
+     * @brief 实例化绘制的逐实例数据, 按属性分数组(SoA)存储, 顶点着色器按实例编号读取
+    */
+    struct InstanceBuffer
+    {
+        std::vector<Mat4> Models;               // 模型矩阵
+        std::vector<Mat4> NormalMatrices;       // 法线矩阵, 见 Mat4NormalMatrix
+        std::vector<Vec3> Colors;               // 实例颜色
+        std::vector<Vec4> TexCoordRegions;      // 纹理坐标变换(图集区域), 纹理坐标 = XY + 原纹理坐标 * ZW
+
+        size_t GetCount() const { return Models.size(); }
+
+        void Add(const Mat4& model, const Mat4& normalMatrix, const Vec3& color, const Vec4& texCoordRegion = { 0.0f, 0.0f, 1.0f, 1.0f })
+        {
+            Models.push_back(model);
+            NormalMatrices.push_back(normalMatrix);
+            Colors.push_back(color);
+            TexCoordRegions.push_back(texCoordRegion);
+        }
+        void Add(const Mat4& model, const Vec3& color = { 1.0f, 1.0f, 1.0f })
+        {
+            Add(model, Mat4NormalMatrix(model), color);
+        }
+        void Clear()
+        {
+            Models.clear();
+            NormalMatrices.clear();
+            Colors.clear();
+            TexCoordRegions.clear();
+        }
+    };
+
 }
\ No newline at end of file
@@ -1,18 +1,312 @@
 #include "Base.h"
+#include "MappedFile.h"
 #include "Maths.h"
 #include "Texture.h"
 
 #include <stb_image/stb_image.h>
+#include <stb_image/stb_dxt.h>
+#include <emmintrin.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
 namespace RGS {
 
-Texture::Texture(const std::string& path)
-    : m_Path(path)
+namespace {
+
+// 8 位通道值到浮点的查找表, 与 UChar2Float 结果一致
+struct UnpackTable
+{
+    float Values[256];
+
+    UnpackTable()
+    {
+        for (int i = 0; i < 256; i++)
+            Values[i] = UChar2Float((unsigned char)i);
+    }
+};
+const UnpackTable s_UnpackTable;
+
+/**
+ * @brief 读取一个纹素并解包为 4 个浮点通道, 缺失的通道为 0
+*/
+inline __m128 LoadTexel(const uint8_t* data, const TextureFormat format, const int index)
+{
+    const float* table = s_UnpackTable.Values;
+    switch (format)
+    {
+    case TextureFormat::R8:
+        return _mm_set_ss(table[data[index]]);
+    case TextureFormat::RG8:
+    {
+        const uint8_t* texel = data + index * 2;
+        return _mm_setr_ps(table[texel[0]], table[texel[1]], 0.0f, 0.0f);
+    }
+    case TextureFormat::RGB8:
+    {
+        const uint8_t* texel = data + index * 3;
+        return _mm_setr_ps(table[texel[0]], table[texel[1]], table[texel[2]], 0.0f);
+    }
+    case TextureFormat::RGBA8:
+    {
+        // 4 个字节零扩展为 4 个 32 位整数后转换为浮点
+        int packed;
+        memcpy(&packed, data + index * 4, sizeof(int));
+        const __m128i zero = _mm_setzero_si128();
+        __m128i texel = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+        return _mm_mul_ps(_mm_cvtepi32_ps(texel), _mm_set1_ps(1.0f / 255.0f));
+    }
+    case TextureFormat::RGBA32F:
+    default:
+        return _mm_loadu_ps((const float*)data + index * 4);
+    }
+}
+
+// 读取一个至多 4 字节的 8 位纹素, 高位补 0 (按固定长度读取, 避免变长 memcpy 调用)
+inline int LoadTexelBits(const uint8_t* texel, const int size)
+{
+    switch (size)
+    {
+    case 1:
+        return texel[0];
+    case 2:
+        return texel[0] | (texel[1] << 8);
+    case 3:
+        return texel[0] | (texel[1] << 8) | (texel[2] << 16);
+    default:
+    {
+        int bits;
+        memcpy(&bits, texel, sizeof(int));
+        return bits;
+    }
+    }
+}
+
+inline void StoreTexelBits(uint8_t* texel, const int size, const int bits)
+{
+    switch (size)
+    {
+    case 1:
+        texel[0] = (uint8_t)bits;
+        break;
+    case 2:
+        texel[0] = (uint8_t)bits;
+        texel[1] = (uint8_t)(bits >> 8);
+        break;
+    case 3:
+        texel[0] = (uint8_t)bits;
+        texel[1] = (uint8_t)(bits >> 8);
+        texel[2] = (uint8_t)(bits >> 16);
+        break;
+    default:
+        memcpy(texel, &bits, sizeof(int));
+        break;
+    }
+}
+
+// .rgstex 文件头, 之后依次为 LevelCount 个 CookedLevel 与纹素数据
+struct CookedHeader
+{
+    char Magic[4];          // "RGST"
+    uint32_t Version;
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t Format;        // TextureFormat
+    uint32_t Layout;        // TextureLayout
+    uint32_t LevelCount;
+    uint32_t Channels;      // 原始通道数, 块压缩格式据此屏蔽解码出的多余通道
+    uint64_t DataOffset;    // 纹素数据相对文件起始的偏移, 按 COOKED_ALIGNMENT 对齐
+    uint64_t DataSize;      // 纹素数据字节数
+};
+
+struct CookedLevel
+{
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t BlocksPerRow;
+    uint32_t Reserved;
+    uint64_t Offset;        // 相对纹素数据起始位置的偏移
+};
+
+constexpr char COOKED_MAGIC[4] = { 'R', 'G', 'S', 'T' };
+constexpr uint32_t COOKED_VERSION = 2;
+constexpr uint64_t COOKED_ALIGNMENT = 64;
+
+// 非压缩格式为每个纹素的字节数, 压缩格式为每个 4x4 块的字节数
+int GetTexelSize(const TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::R8:     return 1;
+    case TextureFormat::RG8:    return 2;
+    case TextureFormat::RGB8:   return 3;
+    case TextureFormat::RGBA8:  return 4;
+    case TextureFormat::BC1:    return 8;
+    case TextureFormat::BC4:    return 8;
+    default:                    return 16;
+    }
+}
+
+int GetChannelCount(const TextureFormat format, const int sourceChannels)
+{
+    switch (format)
+    {
+    case TextureFormat::R8:     return 1;
+    case TextureFormat::RG8:    return 2;
+    case TextureFormat::RGB8:   return 3;
+    case TextureFormat::BC1:    return std::min(sourceChannels, 3);
+    case TextureFormat::BC4:    return 1;
+    default:                    return 4;
+    }
+}
+
+std::atomic<uint32_t> s_NextTextureId { 1 };
+
+/* 块压缩解码: https://learn.microsoft.com/en-us/windows/win32/direct3d10/d3d10-graphics-programming-guide-resources-block-compression */
+
+void Unpack565(uint8_t* rgb, const uint16_t color)
+{
+    int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (uint8_t)((r << 3) | (r >> 2));
+    rgb[1] = (uint8_t)((g << 2) | (g >> 4));
+    rgb[2] = (uint8_t)((b << 3) | (b >> 2));
+}
+
+/**
+ * @brief 解码 BC1 颜色块到 RGBA8
+ * @param forceFourColor BC3 的颜色块总是使用 4 色模式
+*/
+void DecodeColorBlock(uint8_t* texels, const uint8_t* block, const bool forceFourColor)
+{
+    uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+    uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+    uint8_t palette[4][4];
+    Unpack565(palette[0], c0);
+    Unpack565(palette[1], c1);
+    palette[0][3] = palette[1][3] = 255;
+    for (int c = 0; c < 3; c++)
+    {
+        if (forceFourColor || c0 > c1)
+        {
+            palette[2][c] = (uint8_t)((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = (uint8_t)((palette[0][c] + 2 * palette[1][c]) / 3);
+        }
+        else
+        {
+            palette[2][c] = (uint8_t)((palette[0][c] + palette[1][c]) / 2);
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = (forceFourColor || c0 > c1) ? 255 : 0;
+
+    uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+    for (int i = 0; i < 16; i++)
+    {
+        memcpy(texels + i * 4, palette[(indices >> (i * 2)) & 3], 4);
+    }
+}
+
+/**
+ * @brief 解码 BC4 单通道块, 结果写入 texels[i * stride]
+*/
+void DecodeSingleChannelBlock(uint8_t* texels, const int stride, const uint8_t* block)
+{
+    uint8_t palette[8];
+    palette[0] = block[0];
+    palette[1] = block[1];
+    if (palette[0] > palette[1])
+    {
+        for (int i = 1; i < 7; i++)
+            palette[i + 1] = (uint8_t)((palette[0] * (7 - i) + palette[1] * i) / 7);
+    }
+    else
+    {
+        for (int i = 1; i < 5; i++)
+            palette[i + 1] = (uint8_t)((palette[0] * (5 - i) + palette[1] * i) / 5);
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++)
+        indices |= (uint64_t)block[2 + i] << (i * 8);
+    for (int i = 0; i < 16; i++)
+    {
+        texels[i * stride] = palette[(indices >> (i * 3)) & 7];
+    }
+}
+
+// 每个线程独立的已解码块缓存(直接映射), 相邻采样大多落在同一块内, 避免重复解码
+struct DecodedBlockCache
+{
+    static constexpr int SIZE = 256;
+
+    uint32_t TextureIds[SIZE] = {};     // 0 表示空
+    const uint8_t* Blocks[SIZE] = {};
+    alignas(16) uint8_t Texels[SIZE][64];   // 4x4 个 RGBA8 纹素
+};
+thread_local DecodedBlockCache s_BlockCache;
+
+/**
+ * @brief 向下取整, 超出 int 范围或非法的坐标返回 0
+*/
+inline int FloorToInt(const float f)
+{
+    constexpr float limit = (float)(1 << 30);
+    if (!(f > -limit && f < limit))
+        return 0;
+    int i = (int)f;
+    return i - (f < (float)i);
+}
+
+/**
+ * @brief 按寻址方式将纹素坐标映射到 [0, size)
+ * @param mask size 为 2 的幂时为 size - 1, 使用位运算代替取模, 否则为 -1
+*/
+inline int WrapTexel(const int i, const int size, const int mask, const WrapMode mode)
+{
+    switch (mode)
+    {
+    case WrapMode::REPEAT:
+        if (mask >= 0)
+            return i & mask;
+        else
+        {
+            int r = i % size;
+            return r < 0 ? r + size : r;
+        }
+    case WrapMode::MIRROR:
+    {
+        int period = size * 2;
+        int r = mask >= 0 ? (i & (period - 1)) : i % period;
+        if (r < 0)
+            r += period;
+        return r < size ? r : period - 1 - r;
+    }
+    case WrapMode::CLAMP:
+    default:
+        return i < 0 ? 0 : (i >= size ? size - 1 : i);
+    }
+}
+
+}
+
+Texture::Texture(const std::string& path, const TextureOptions& options)
+    : m_Id(s_NextTextureId++), m_Path(path), m_Options(options)
 {
     Init();
 }
 
+Texture::Texture(const int width, const int height, const TextureFormat format, const void* data, const TextureOptions& options)
+    : m_Id(s_NextTextureId++), m_Options(options)
+{
+    InitLevels(width, height, format, data);
+}
+
 Texture::~Texture()
 {
     if (m_Data)
@@ -22,71 +316,434 @@ Texture::~Texture()
 
 void Texture::Init()
 {
+    const std::string extension = COOKED_EXTENSION;
+    if (m_Path.size() > extension.size() && m_Path.compare(m_Path.size() - extension.size(), extension.size(), extension) == 0)
+    {
+        InitCooked();
+        return;
+    }
+
     int width, height, channels;
-    stbi_set_flip_vertically_on_load(1);    // 翻转纹理
-    stbi_uc* data = nullptr;    // stbi_uc 是无符号字符类型，通常用于表示图像数据
-    data = stbi_load(m_Path.c_str(), &width, &height, &channels, 0);    // 加载纹理数据, 0 表示加载所有通道
+    stbi_set_flip_vertically_on_load_thread(1);    // 翻转纹理(只影响当前线程, 允许多个线程同时加载)
+    bool floatStorage = m_Options.FloatStorage || stbi_is_hdr(m_Path.c_str());
+    void* data = nullptr;
+    if (floatStorage)
+        data = stbi_loadf(m_Path.c_str(), &width, &height, &channels, 4);   // 浮点数据统一扩展为 4 通道
+    else
+        data = stbi_load(m_Path.c_str(), &width, &height, &channels, 0);    // 加载纹理数据, 0 表示按原始通道数加载
     ASSERT(data);
 
+    TextureFormat format = floatStorage ? TextureFormat::RGBA32F : (TextureFormat)((int)TextureFormat::R8 + channels - 1);
+    InitLevels(width, height, format, data);
+    stbi_image_free(data);
+}
+
+void Texture::InitLevels(const int width, const int height, const TextureFormat format, const void* data)
+{
+    ASSERT((width > 0) && (height > 0) && data && format <= TextureFormat::RGBA32F);
     m_Height = height;
     m_Width = width;
-    m_Channels = channels;
-    int size = height * width;
-    m_Data = new Vec4[size];
+    m_Format = format;
+    m_Channels = GetChannelCount(format, 4);
+    m_TexelSize = GetTexelSize(m_Format);
 
-    if (channels == 4)
+    // 计算 mipmap 链所需的总空间, 所有层级放在同一块内存中, 分块布局时每层补齐到整块
+    const bool tiled = m_Options.Layout == TextureLayout::TILED;
+    std::vector<size_t> levelTexels;
+    size_t totalTexels = 0;
+    int levelWidth = width, levelHeight = height;
+    while (true)
     {
-        for (int i = 0; i < size; i++)
+        int blocksPerRow = (levelWidth + TILE_MASK) >> TILE_SHIFT;
+        int blocksPerColumn = (levelHeight + TILE_MASK) >> TILE_SHIFT;
+        size_t texels = tiled ? (size_t)blocksPerRow * blocksPerColumn * TILE_SIZE * TILE_SIZE
+                              : (size_t)levelWidth * levelHeight;
+        m_Levels.push_back(MakeLevel(levelWidth, levelHeight, blocksPerRow, totalTexels * m_TexelSize, nullptr));
+        levelTexels.push_back(texels);
+        totalTexels += texels;
+        if (!m_Options.GenerateMipmaps || (levelWidth == 1 && levelHeight == 1))
+            break;
+        if (m_Options.MaxLevelCount > 0 && (int)m_Levels.size() >= m_Options.MaxLevelCount)
+            break;
+        levelWidth = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+    }
+    m_DataSize = totalTexels * m_TexelSize;
+    m_Data = new uint8_t[m_DataSize]();
+    for (Level& level : m_Levels)
+    {
+        level.Data = m_Data + level.Offset;
+    }
+
+    // 原始纹理保留加载时的紧凑格式, 分块布局时逐行拆分到各纹素块中
+    if (tiled)
+    {
+        const uint8_t* src = (const uint8_t*)data;
+        const Level& level = m_Levels[0];
+        for (int y = 0; y < height; y++)
         {
-            m_Data[i].X = UChar2Float(data[i * 4]);
-            m_Data[i].Y = UChar2Float(data[i * 4 + 1]);
-            m_Data[i].Z = UChar2Float(data[i * 4 + 2]);
-            m_Data[i].W = UChar2Float(data[i * 4 + 3]);
+            for (int x = 0; x < width; x += TILE_SIZE)
+            {
+                int count = std::min(TILE_SIZE, width - x);
+                memcpy(m_Data + level.Offset + (size_t)GetTexelIndex(level, x, y) * m_TexelSize,
+                       src + ((size_t)y * width + x) * m_TexelSize, (size_t)count * m_TexelSize);
+            }
         }
     }
-    else if (channels == 3)
+    else
     {
-        for (int i = 0; i < size; i++)
+        memcpy(m_Data, data, (size_t)width * height * m_TexelSize);
+    }
+
+    GenerateMipmaps();
+    if (m_Options.Compress && m_Format != TextureFormat::RGBA32F)
+        CompressLevels();
+}
+
+void Texture::InitCooked()
+{
+    m_File = std::make_unique<MappedFile>(m_Path);
+    ASSERT(m_File->IsValid());
+    const uint8_t* file = m_File->GetData();
+    const size_t fileSize = m_File->GetSize();
+
+    ASSERT(fileSize >= sizeof(CookedHeader));
+    CookedHeader header;
+    memcpy(&header, file, sizeof(CookedHeader));
+    ASSERT(memcmp(header.Magic, COOKED_MAGIC, sizeof(COOKED_MAGIC)) == 0 && header.Version == COOKED_VERSION);
+    ASSERT(header.LevelCount > 0 && sizeof(CookedHeader) + header.LevelCount * sizeof(CookedLevel) <= header.DataOffset);
+    ASSERT(header.DataOffset + header.DataSize <= fileSize);
+
+    m_Width = (int)header.Width;
+    m_Height = (int)header.Height;
+    m_Format = (TextureFormat)header.Format;
+    m_Channels = GetChannelCount(m_Format, (int)header.Channels);
+    m_TexelSize = GetTexelSize(m_Format);
+    m_Options.Layout = (TextureLayout)header.Layout;
+    m_Options.GenerateMipmaps = header.LevelCount > 1;
+    m_DataSize = (size_t)header.DataSize;
+
+    // 纹素数据直接指向映射的文件内容, 不解码也不拷贝
+    const uint8_t* texels = file + header.DataOffset;
+    for (uint32_t l = 0; l < header.LevelCount; l++)
+    {
+        CookedLevel cooked;
+        memcpy(&cooked, file + sizeof(CookedHeader) + l * sizeof(CookedLevel), sizeof(CookedLevel));
+        ASSERT(cooked.Offset < header.DataSize);
+        m_Levels.push_back(MakeLevel((int)cooked.Width, (int)cooked.Height, (int)cooked.BlocksPerRow, (size_t)cooked.Offset, texels + cooked.Offset));
+    }
+}
+
+bool Texture::SaveCooked(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    CookedHeader header = {};
+    memcpy(header.Magic, COOKED_MAGIC, sizeof(COOKED_MAGIC));
+    header.Version = COOKED_VERSION;
+    header.Width = (uint32_t)m_Width;
+    header.Height = (uint32_t)m_Height;
+    header.Format = (uint32_t)m_Format;
+    header.Layout = (uint32_t)m_Options.Layout;
+    header.LevelCount = (uint32_t)m_Levels.size();
+    header.Channels = (uint32_t)m_Channels;
+    uint64_t tableEnd = sizeof(CookedHeader) + m_Levels.size() * sizeof(CookedLevel);
+    header.DataOffset = (tableEnd + COOKED_ALIGNMENT - 1) / COOKED_ALIGNMENT * COOKED_ALIGNMENT;
+    header.DataSize = m_DataSize;
+    file.write((const char*)&header, sizeof(header));
+
+    for (const Level& level : m_Levels)
+    {
+        CookedLevel cooked = { (uint32_t)level.Width, (uint32_t)level.Height, (uint32_t)level.BlocksPerRow, 0, (uint64_t)level.Offset };
+        file.write((const char*)&cooked, sizeof(cooked));
+    }
+
+    const char padding[COOKED_ALIGNMENT] = {};
+    file.write(padding, (std::streamsize)(header.DataOffset - tableEnd));
+    file.write((const char*)m_Levels[0].Data, (std::streamsize)m_DataSize);
+    return (bool)file;
+}
+
+void Texture::CompressLevels()
+{
+    /* 逐层按 4x4 块压缩, 块按行排列(压缩块本身即为分块布局, 不再使用 m_Options.Layout) */
+    TextureFormat format = TextureFormat::BC1;
+    if (m_Format == TextureFormat::R8)
+        format = TextureFormat::BC4;
+    else if (m_Format == TextureFormat::RGBA8)
+        format = TextureFormat::BC3;
+    const int blockSize = GetTexelSize(format);
+
+    std::vector<Level> levels;
+    size_t dataSize = 0;
+    for (const Level& level : m_Levels)
+    {
+        int blocksPerRow = (level.Width + 3) >> BC_BLOCK_SHIFT;
+        int blocksPerColumn = (level.Height + 3) >> BC_BLOCK_SHIFT;
+        levels.push_back(MakeLevel(level.Width, level.Height, blocksPerRow, dataSize, nullptr));
+        dataSize += (size_t)blocksPerRow * blocksPerColumn * blockSize;
+    }
+    uint8_t* data = new uint8_t[dataSize];
+
+    for (size_t l = 0; l < m_Levels.size(); l++)
+    {
+        const Level& src = m_Levels[l];
+        const Level& dst = levels[l];
+        int blocksPerColumn = (src.Height + 3) >> BC_BLOCK_SHIFT;
+        for (int by = 0; by < blocksPerColumn; by++)
         {
-            m_Data[i].X = UChar2Float(data[i * 3]);
-            m_Data[i].Y = UChar2Float(data[i * 3 + 1]);
-            m_Data[i].Z = UChar2Float(data[i * 3 + 2]);
-            m_Data[i].W = 0.0f;    
+            for (int bx = 0; bx < dst.BlocksPerRow; bx++)
+            {
+                // 取出 4x4 纹素并扩展为 RGBA8, 超出边界的纹素取边界值
+                uint8_t rgba[16 * 4];
+                uint8_t red[16];
+                for (int i = 0; i < 16; i++)
+                {
+                    int x = std::min((bx << BC_BLOCK_SHIFT) + (i & 3), src.Width - 1);
+                    int y = std::min((by << BC_BLOCK_SHIFT) + (i >> 2), src.Height - 1);
+                    const uint8_t* texel = src.Data + (size_t)GetTexelIndex(src, x, y) * m_TexelSize;
+                    uint8_t* out = rgba + i * 4;
+                    out[0] = texel[0];
+                    out[1] = m_TexelSize > 1 ? texel[1] : 0;
+                    out[2] = m_TexelSize > 2 ? texel[2] : 0;
+                    out[3] = m_TexelSize > 3 ? texel[3] : 255;
+                    red[i] = texel[0];
+                }
+
+                uint8_t* block = data + dst.Offset + ((size_t)by * dst.BlocksPerRow + bx) * blockSize;
+                if (format == TextureFormat::BC4)
+                    stb_compress_bc4_block(block, red);
+                else
+                    stb_compress_dxt_block(block, rgba, format == TextureFormat::BC3 ? 1 : 0, STB_DXT_HIGHQUAL);
+            }
         }
     }
-    else if (channels == 2) 
+
+    delete[] m_Data;
+    m_Data = data;
+    m_DataSize = dataSize;
+    m_Format = format;
+    m_TexelSize = blockSize;
+    m_Levels = levels;
+    for (Level& level : m_Levels)
     {
-        for (int i = 0; i < size; i++)
+        level.Data = m_Data + level.Offset;
+    }
+}
+
+__m128 Texture::FetchTexel(const Level& level, const int x, const int y) const
+{
+    if (!IsCompressed())
+        return LoadTexel(level.Data, m_Format, GetTexelIndex(level, x, y));
+
+    const uint8_t* block = level.Data + ((size_t)(y >> BC_BLOCK_SHIFT) * level.BlocksPerRow + (x >> BC_BLOCK_SHIFT)) * m_TexelSize;
+    DecodedBlockCache& cache = s_BlockCache;
+    int slot = (int)((((uintptr_t)block >> 3) ^ m_Id * 0x9E3779B1u) & (DecodedBlockCache::SIZE - 1));
+    uint8_t* texels = cache.Texels[slot];
+    if (cache.Blocks[slot] != block || cache.TextureIds[slot] != m_Id)
+    {
+        switch (m_Format)
+        {
+        case TextureFormat::BC1:
+            DecodeColorBlock(texels, block, false);
+            break;
+        case TextureFormat::BC3:
+            DecodeColorBlock(texels, block + 8, true);
+            DecodeSingleChannelBlock(texels + 3, 4, block);
+            break;
+        default:
+            memset(texels, 0, 64);
+            DecodeSingleChannelBlock(texels, 4, block);
+            break;
+        }
+        // 与非压缩格式一致, 原始纹理缺少的通道为 0
+        for (int i = 0; i < 16; i++)
         {
-            m_Data[i].X = UChar2Float(data[i * 2]);
-            m_Data[i].Y = UChar2Float(data[i * 2 + 1]);
-            m_Data[i].Z = 0.0f;    
-            m_Data[i].W = 0.0f;   
+            for (int c = m_Channels; c < 4; c++)
+                texels[i * 4 + c] = 0;
         }
+        cache.Blocks[slot] = block;
+        cache.TextureIds[slot] = m_Id;
     }
-    else if (channels == 1) 
+    return LoadTexel(texels, TextureFormat::RGBA8, ((y & 3) << 2) + (x & 3));
+}
+
+void Texture::GenerateMipmaps()
+{
+    /* 2x2 盒式滤波逐级下采样, 奇数尺寸时最后一行/列取边界像素 */
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    for (size_t l = 1; l < m_Levels.size(); l++)
     {
-        for (int i = 0; i < size; i++)
+        const Level& src = m_Levels[l - 1];
+        const Level& dst = m_Levels[l];
+        for (int y = 0; y < dst.Height; y++)
         {
-            m_Data[i].X = UChar2Float(data[i]);
-            m_Data[i].Y = 0.0f;    
-            m_Data[i].Z = 0.0f;   
-            m_Data[i].W = 0.0f;    
+            int y0 = std::min(y * 2, src.Height - 1);
+            int y1 = std::min(y * 2 + 1, src.Height - 1);
+            for (int x = 0; x < dst.Width; x++)
+            {
+                int x0 = std::min(x * 2, src.Width - 1);
+                int x1 = std::min(x * 2 + 1, src.Width - 1);
+                int i00 = GetTexelIndex(src, x0, y0);
+                int i10 = GetTexelIndex(src, x1, y0);
+                int i01 = GetTexelIndex(src, x0, y1);
+                int i11 = GetTexelIndex(src, x1, y1);
+                int dstIndex = GetTexelIndex(dst, x, y);
+                if (m_Format == TextureFormat::RGBA32F)
+                {
+                    const float* srcData = (const float*)src.Data;
+                    __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(srcData + i00 * 4), _mm_loadu_ps(srcData + i10 * 4)),
+                                            _mm_add_ps(_mm_loadu_ps(srcData + i01 * 4), _mm_loadu_ps(srcData + i11 * 4)));
+                    _mm_storeu_ps((float*)(m_Data + dst.Offset) + dstIndex * 4, _mm_mul_ps(sum, quarter));
+                }
+                else
+                {
+                    // 8 位通道: 每行两个纹素并入一个寄存器, 扩展为 16 位后两行相加, 再两列相加, (sum + 2) >> 2 四舍五入
+                    __m128i top = _mm_unpacklo_epi32(_mm_cvtsi32_si128(LoadTexelBits(src.Data + i00 * m_TexelSize, m_TexelSize)),
+                                                     _mm_cvtsi32_si128(LoadTexelBits(src.Data + i10 * m_TexelSize, m_TexelSize)));
+                    __m128i bottom = _mm_unpacklo_epi32(_mm_cvtsi32_si128(LoadTexelBits(src.Data + i01 * m_TexelSize, m_TexelSize)),
+                                                        _mm_cvtsi32_si128(LoadTexelBits(src.Data + i11 * m_TexelSize, m_TexelSize)));
+                    __m128i sum = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+                    sum = _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+                    sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+                    int bits = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+                    StoreTexelBits(m_Data + dst.Offset + dstIndex * m_TexelSize, m_TexelSize, bits);
+                }
+            }
         }
     }
 }
 
-Vec4 Texture::Sample(Vec2 texCoords) const 
+Vec4 Texture::Sample(const Sampler& sampler, Vec2 texCoords) const 
+{
+    if (sampler.Filter == TextureFilter::NEAREST)
+        return SampleNearest(sampler, m_Levels[0], texCoords);
+    return SampleBilinear(sampler, m_Levels[0], texCoords);
+}
+
+Vec4 Texture::Sample(const Sampler& sampler, Vec2 texCoords, Vec2 ddx, Vec2 ddy) const
+{
+    if (sampler.Filter != TextureFilter::TRILINEAR || m_Levels.size() == 1)
+        return Sample(sampler, texCoords);
+
+    /* 根据纹理坐标在屏幕上的变化率选择层级: lod = log2(max(|ddx|, |ddy|)) (以纹素为单位) */
+    const Level& base = m_Levels[0];
+    float dxU = ddx.X * base.ScaleX, dxV = ddx.Y * base.ScaleY;
+    float dyU = ddy.X * base.ScaleX, dyV = ddy.Y * base.ScaleY;
+    float lenSq = std::max(dxU * dxU + dxV * dxV, dyU * dyU + dyV * dyV);
+    float lod = sampler.LodBias;
+    if (lenSq > 1.0f && std::isfinite(lenSq))
+        lod += 0.5f * std::log2(lenSq);
+    return SampleLevel(sampler, texCoords, lod);
+}
+
+Vec4 Texture::SampleLevel(const Sampler& sampler, Vec2 texCoords, float lod) const
+{
+    /* 三线性采样 */
+    float maxLevel = (float)(m_Levels.size() - 1);
+    lod = Clamp(lod, 0.0f, maxLevel);
+    int level0 = (int)lod;
+    float t = lod - (float)level0;
+    Vec4 color = SampleBilinear(sampler, m_Levels[level0], texCoords);
+    if (t > 0.0f)
+    {
+        color = Lerp(color, SampleBilinear(sampler, m_Levels[level0 + 1], texCoords), t);
+    }
+    return color;
+}
+
+Vec4 Texture::SampleNearest(const Sampler& sampler, const Level& level, Vec2 texCoords) const
 {
     /* 点采样 */
-    float vx = Clamp(texCoords.X, 0.0f, 1.0f);
-    float vy = Clamp(texCoords.Y, 0.0f, 1.0f);
+    int x = WrapTexel(FloorToInt(texCoords.X * level.ScaleX), level.Width, level.MaskX, sampler.WrapU);
+    int y = WrapTexel(FloorToInt(texCoords.Y * level.ScaleY), level.Height, level.MaskY, sampler.WrapV);
+
+    Vec4 result;
+    _mm_storeu_ps(&result.X, FetchTexel(level, x, y));
+    return result;
+}
+
+Vec4 Texture::SampleBilinear(const Sampler& sampler, const Level& level, Vec2 texCoords) const
+{
+    /* 双线性采样 */
+    float fx = texCoords.X * level.ScaleX - 0.5f;
+    float fy = texCoords.Y * level.ScaleY - 0.5f;
+    int floorX = FloorToInt(fx);
+    int floorY = FloorToInt(fy);
+    float tx = fx - (float)floorX;
+    float ty = fy - (float)floorY;
+    if (!(tx >= 0.0f && tx <= 1.0f))    // 纹理坐标非法(NaN/无穷大)
+        tx = 0.0f;
+    if (!(ty >= 0.0f && ty <= 1.0f))
+        ty = 0.0f;
 
-    int x = vx * (m_Width - 1) + 0.5f;
-    int y = vy * (m_Height - 1) + 0.5f;
+    int x0 = WrapTexel(floorX, level.Width, level.MaskX, sampler.WrapU);
+    int y0 = WrapTexel(floorY, level.Height, level.MaskY, sampler.WrapV);
+    int x1 = WrapTexel(floorX + 1, level.Width, level.MaskX, sampler.WrapU);
+    int y1 = WrapTexel(floorY + 1, level.Height, level.MaskY, sampler.WrapV);
 
-    int index = y * m_Width + x;
-    return m_Data[index];
+    // 一次取出 2x2 纹素(每个纹素解包后 4 个通道正好一个寄存器), 权重只计算一次, 四个通道同时混合
+    __m128 t00 = FetchTexel(level, x0, y0);
+    __m128 t10 = FetchTexel(level, x1, y0);
+    __m128 t01 = FetchTexel(level, x0, y1);
+    __m128 t11 = FetchTexel(level, x1, y1);
+
+    __m128 w00 = _mm_set1_ps((1.0f - tx) * (1.0f - ty));
+    __m128 w10 = _mm_set1_ps(tx * (1.0f - ty));
+    __m128 w01 = _mm_set1_ps((1.0f - tx) * ty);
+    __m128 w11 = _mm_set1_ps(tx * ty);
+
+    __m128 color = _mm_add_ps(_mm_add_ps(_mm_mul_ps(t00, w00), _mm_mul_ps(t10, w10)),
+                              _mm_add_ps(_mm_mul_ps(t01, w01), _mm_mul_ps(t11, w11)));
+    Vec4 result;
+    _mm_storeu_ps(&result.X, color);
+    return result;
+}
+
+Texture::Level Texture::MakeLevel(const int width, const int height, const int blocksPerRow, const size_t offset, const uint8_t* data)
+{
+    Level level;
+    level.Width = width;
+    level.Height = height;
+    level.BlocksPerRow = blocksPerRow;
+    level.Offset = offset;
+    level.Data = data;
+    level.ScaleX = (float)width;
+    level.ScaleY = (float)height;
+    level.MaskX = (width & (width - 1)) == 0 ? width - 1 : -1;
+    level.MaskY = (height & (height - 1)) == 0 ? height - 1 : -1;
+    return level;
 }
 
-}
\ No newline at end of file
+std::unique_ptr<Texture> LoadMaterialTexture(const std::string& diffusePath, const std::string& specularPath, const TextureOptions& options)
+{
+    int width, height, channels;
+    int specularWidth, specularHeight, specularChannels;
+    stbi_set_flip_vertically_on_load_thread(1);
+    stbi_uc* diffuse = stbi_load(diffusePath.c_str(), &width, &height, &channels, 3);
+    stbi_uc* specular = stbi_load(specularPath.c_str(), &specularWidth, &specularHeight, &specularChannels, 1);
+    ASSERT(diffuse && specular);
+
+    // 漫反射 RGB 与镜面反射强度交错为 RGBA, 同一纹理坐标的两者位于同一纹素
+    std::vector<uint8_t> texels((size_t)width * height * 4);
+    for (int y = 0; y < height; y++)
+    {
+        int sy = (int)(((int64_t)y * specularHeight) / height);
+        for (int x = 0; x < width; x++)
+        {
+            int sx = (int)(((int64_t)x * specularWidth) / width);
+            uint8_t* texel = &texels[((size_t)y * width + x) * 4];
+            memcpy(texel, &diffuse[((size_t)y * width + x) * 3], 3);
+            texel[3] = specular[(size_t)sy * specularWidth + sx];
+        }
+    }
+    stbi_image_free(diffuse);
+    stbi_image_free(specular);
+    return std::make_unique<Texture>(width, height, TextureFormat::RGBA8, texels.data(), options);
+}
+
+}
@@ -1,28 +1,158 @@
 #pragma once
 
 #include "RGS/Maths.h"
+#include "RGS/Sampler.h"
 
+#include <emmintrin.h>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace RGS {
 
+class MappedFile;
+
+enum class TextureFormat
+{
+    R8,             // 单通道, 1 字节/纹素
+    RG8,            // 双通道, 2 字节/纹素
+    RGB8,           // 三通道, 3 字节/纹素
+    RGBA8,          // 四通道, 4 字节/纹素
+    RGBA32F,        // 四通道浮点, 16 字节/纹素(HDR)
+    BC1,            // 块压缩 RGB, 每 4x4 纹素 8 字节
+    BC3,            // 块压缩 RGBA, 每 4x4 纹素 16 字节
+    BC4,            // 块压缩单通道, 每 4x4 纹素 8 字节
+};
+
+enum class TextureLayout
+{
+    LINEAR,         // 按行存储
+    TILED,          // 按 8x8 纹素块存储, 块内按行存储, 任意方向遍历时相邻纹素大多落在同一块内
+};
+
+struct TextureOptions
+{
+    bool GenerateMipmaps = true;                    // 是否生成 mipmap 链
+    int MaxLevelCount = 0;                          // mipmap 链的最大层数(含原始纹理), 0 为一直生成到 1x1
+    bool FloatStorage = false;                      // 是否强制以浮点格式存储, HDR 图片总是以浮点格式存储
+    TextureLayout Layout = TextureLayout::TILED;    // 纹素存储布局
+    bool Compress = false;                          // 是否块压缩 8 位纹理: 单通道为 BC4, 四通道为 BC3, 其余为 BC1
+};
+
 class Texture
 {
 public:
-    Texture(const std::string& path);
+    /**
+     * @brief 加载纹理, 扩展名为 .rgstex 的预处理纹理直接映射文件使用, 不做解码与拷贝
+     * @param options 加载参数, 预处理纹理忽略加载参数(格式、布局与 mipmap 由文件决定)
+    */
+    Texture(const std::string& path, const TextureOptions& options = {});
+    /**
+     * @brief 从内存中的纹素数据创建纹理
+     * @param data 按行紧凑排列的原始纹理数据, 格式由 format 指定, 构造后不再引用
+    */
+    Texture(const int width, const int height, const TextureFormat format, const void* data, const TextureOptions& options = {});
     ~Texture();
 
-    Vec4 Sample(Vec2 texCoords) const;  // 纹理采样
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    int GetLevelCount() const { return (int)m_Levels.size(); }
+    TextureFormat GetFormat() const { return m_Format; }
+    bool IsCompressed() const { return m_Format >= TextureFormat::BC1; }
+    TextureLayout GetLayout() const { return m_Options.Layout; }
+    size_t GetMemorySize() const { return m_DataSize; }     // 所有 mipmap 层级占用的字节数
+    bool IsMapped() const { return m_File != nullptr; }     // 纹素数据是否直接来自映射的预处理文件
+
+    Vec4 Sample(const Sampler& sampler, Vec2 texCoords) const;  // 纹理采样(按过滤方式在原始纹理上采样)
+    /**
+     * @brief 纹理采样, 三线性过滤时根据纹理坐标的屏幕空间导数选择 mipmap 层级
+     * @param sampler 采样器状态
+     * @param texCoords 纹理坐标
+     * @param ddx 纹理坐标沿屏幕 x 方向的差分
+     * @param ddy 纹理坐标沿屏幕 y 方向的差分
+    */
+    Vec4 Sample(const Sampler& sampler, Vec2 texCoords, Vec2 ddx, Vec2 ddy) const;
+    /**
+     * @brief 在指定 mipmap 层级上采样, 非整数层级在相邻两层的双线性结果之间插值
+     * @param sampler 采样器状态, 只使用其中的寻址方式
+     * @param texCoords 纹理坐标
+     * @param lod mipmap 层级, 0 为原始纹理
+    */
+    Vec4 SampleLevel(const Sampler& sampler, Vec2 texCoords, float lod) const;
+
+    /**
+     * @brief 将纹理(含所有 mipmap 层级)按内存中的布局写入 .rgstex 文件
+     * @return 是否写入成功
+    */
+    bool SaveCooked(const std::string& path) const;
+
+    static constexpr const char* COOKED_EXTENSION = ".rgstex";
 
 private:
+    struct Level
+    {
+        int Width;
+        int Height;
+        int BlocksPerRow;   // 分块布局下每行的纹素块数量
+        size_t Offset;      // 该层级相对纹素数据起始位置的字节偏移
+        const uint8_t* Data;    // 该层级的起始位置
+        float ScaleX;       // 纹理坐标到纹素坐标的缩放, 即 (float)Width
+        float ScaleY;
+        int MaskX;          // 宽度为 2 的幂时为 Width - 1, 用于位运算寻址, 否则为 -1
+        int MaskY;
+    };
+
+    static constexpr int BC_BLOCK_SHIFT = 2;            // 压缩块边长为 1 << BC_BLOCK_SHIFT
+    static constexpr int TILE_SHIFT = 3;                // 纹素块边长为 1 << TILE_SHIFT
+    static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+    static constexpr int TILE_MASK = TILE_SIZE - 1;
+
+    /**
+     * @brief 计算纹素在层级数据中的索引, 与存储布局相关
+    */
+    int GetTexelIndex(const Level& level, const int x, const int y) const
+    {
+        if (m_Options.Layout == TextureLayout::LINEAR)
+            return y * level.Width + x;
+        int block = (y >> TILE_SHIFT) * level.BlocksPerRow + (x >> TILE_SHIFT);
+        return (block << (TILE_SHIFT * 2)) + ((y & TILE_MASK) << TILE_SHIFT) + (x & TILE_MASK);
+    }
+
     void Init();
+    void InitCooked();      // 映射 .rgstex 文件
+    void InitLevels(const int width, const int height, const TextureFormat format, const void* data);   // 分配 mipmap 链并写入原始纹理
+    void GenerateMipmaps();
+    void CompressLevels();      // 将所有层级压缩为块压缩格式
+    /**
+     * @brief 读取一个纹素并解包为 4 个浮点通道, 压缩格式通过线程局部的已解码块缓存读取
+    */
+    __m128 FetchTexel(const Level& level, const int x, const int y) const;
+    static Level MakeLevel(const int width, const int height, const int blocksPerRow, const size_t offset, const uint8_t* data);     // 同时预计算层级的缩放与寻址掩码
+    Vec4 SampleNearest(const Sampler& sampler, const Level& level, Vec2 texCoords) const;
+    Vec4 SampleBilinear(const Sampler& sampler, const Level& level, Vec2 texCoords) const;
 
 private:
+    uint32_t m_Id;          // 纹理唯一标识, 用于区分已解码块缓存中不同纹理的块
     int m_Width;
     int m_Height;
     int m_Channels;         
     std::string m_Path;
-    Vec4* m_Data = nullptr;
+    TextureOptions m_Options;
+    TextureFormat m_Format = TextureFormat::RGBA8;
+    int m_TexelSize = 4;            // 每个纹素的字节数
+    uint8_t* m_Data = nullptr;      // 所有 mipmap 层级连续存放, 按 m_Format 紧凑排列; 映射文件时为空
+    size_t m_DataSize = 0;
+    std::unique_ptr<MappedFile> m_File;     // 映射的预处理文件
+    std::vector<Level> m_Levels;    // mipmap 链, m_Levels[0] 为原始纹理
 };
 
-}
\ No newline at end of file
+/**
+ * @brief 将漫反射纹理(RGB)与镜面反射纹理(转换为灰度)交错存储为一张 RGBA8 材质纹理, 着色时一次采样同时得到两者
+ * @param diffusePath 漫反射纹理路径
+ * @param specularPath 镜面反射纹理路径, 尺寸与漫反射纹理不同时按最近点缩放
+ * @param options 加载参数, 块压缩时为 BC3
+*/
+std::unique_ptr<Texture> LoadMaterialTexture(const std::string& diffusePath, const std::string& specularPath, const TextureOptions& options = {});
+
+}
@@ -0,0 +1,195 @@
+#include "Base.h"
+#include "TextureAtlas.h"
+
+#include <stb_image/stb_image.h>
+#include <stb_image/stb_rect_pack.h>
+#include <algorithm>
+#include <cstring>
+
+namespace RGS {
+
+namespace {
+
+int NextPowerOfTwo(const int value)
+{
+    int result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+}
+
+TextureAtlas::TextureAtlas(const int layerCount, const int pageSize, const int padding)
+    : m_LayerCount(layerCount), m_PageSize(pageSize), m_Padding(padding), m_AlignShift(0), m_Channels(layerCount, 1)
+{
+    ASSERT(layerCount > 0 && pageSize > 0 && padding >= 0);
+    while ((2 << m_AlignShift) <= m_Padding)
+        m_AlignShift++;
+}
+
+int TextureAtlas::Add(const std::vector<std::string>& layerPaths)
+{
+    ASSERT((int)layerPaths.size() == m_LayerCount);
+    ASSERT(m_Pages.empty());
+
+    Entry entry;
+    stbi_set_flip_vertically_on_load_thread(1);
+    for (int layer = 0; layer < m_LayerCount; layer++)
+    {
+        int width, height, channels;
+        stbi_uc* image = stbi_load(layerPaths[layer].c_str(), &width, &height, &channels, 4);
+        if (!image)
+            return -1;
+
+        // 与 Texture 一致: 灰度+透明度存为 (Y, A), 缺失的通道读作 0
+        size_t texelCount = (size_t)width * height;
+        for (size_t i = 0; i < texelCount; i++)
+        {
+            if (channels == 2)
+                image[i * 4 + 1] = image[i * 4 + 3];    // stbi 展开为 (Y, Y, Y, A)
+            for (int c = channels; c < 4; c++)
+                image[i * 4 + c] = 0;
+        }
+        m_Channels[layer] = std::max(m_Channels[layer], channels);
+
+        if (layer == 0)
+        {
+            entry.Width = width;
+            entry.Height = height;
+            entry.Layers.emplace_back(image, image + texelCount * 4);
+        }
+        else
+        {
+            // 按第一层尺寸最近点缩放
+            std::vector<uint8_t> resized((size_t)entry.Width * entry.Height * 4);
+            for (int y = 0; y < entry.Height; y++)
+            {
+                int sy = (int)(((int64_t)y * height) / entry.Height);
+                for (int x = 0; x < entry.Width; x++)
+                {
+                    int sx = (int)(((int64_t)x * width) / entry.Width);
+                    memcpy(&resized[((size_t)y * entry.Width + x) * 4], &image[((size_t)sy * width + sx) * 4], 4);
+                }
+            }
+            entry.Layers.push_back(std::move(resized));
+        }
+        stbi_image_free(image);
+    }
+
+    const int gridSize = m_PageSize >> m_AlignShift;
+    ASSERT((entry.Width + m_Padding * 2 + (1 << m_AlignShift) - 1) >> m_AlignShift <= gridSize
+        && (entry.Height + m_Padding * 2 + (1 << m_AlignShift) - 1) >> m_AlignShift <= gridSize);
+    m_Entries.push_back(std::move(entry));
+    return (int)m_Entries.size() - 1;
+}
+
+void TextureAtlas::Build(const TextureOptions& options)
+{
+    ASSERT(m_Pages.empty());
+
+    /*
+     * 打包: 放不下的条目放入下一页
+     * 以 align 个纹素为单位打包, 条目起点对齐到 align, 第 m_AlignShift 级 mipmap 上条目四周仍有一整圈间隔纹素,
+     * 双线性过滤不会采样到相邻条目; 更粗糙的层级不再生成
+    */
+    const int align = 1 << m_AlignShift;
+    const int gridSize = m_PageSize >> m_AlignShift;
+    std::vector<stbrp_rect> pending(m_Entries.size());
+    for (size_t i = 0; i < m_Entries.size(); i++)
+    {
+        pending[i] = {};
+        pending[i].id = (int)i;
+        pending[i].w = (m_Entries[i].Width + m_Padding * 2 + align - 1) >> m_AlignShift;
+        pending[i].h = (m_Entries[i].Height + m_Padding * 2 + align - 1) >> m_AlignShift;
+    }
+
+    TextureOptions pageOptions = options;
+    if (pageOptions.MaxLevelCount <= 0 || pageOptions.MaxLevelCount > m_AlignShift + 1)
+        pageOptions.MaxLevelCount = m_AlignShift + 1;
+
+    std::vector<stbrp_node> nodes(gridSize);
+    while (!pending.empty())
+    {
+        stbrp_context context;
+        stbrp_init_target(&context, gridSize, gridSize, nodes.data(), (int)nodes.size());
+        stbrp_pack_rects(&context, pending.data(), (int)pending.size());
+
+        std::vector<stbrp_rect> packed, remaining;
+        int usedWidth = 1, usedHeight = 1;
+        for (stbrp_rect& rect : pending)
+        {
+            if (rect.was_packed)
+            {
+                // 换算回纹素
+                rect.x <<= m_AlignShift;
+                rect.y <<= m_AlignShift;
+                rect.w <<= m_AlignShift;
+                rect.h <<= m_AlignShift;
+                packed.push_back(rect);
+                usedWidth = std::max(usedWidth, rect.x + rect.w);
+                usedHeight = std::max(usedHeight, rect.y + rect.h);
+            }
+            else
+                remaining.push_back(rect);
+        }
+        ASSERT(!packed.empty());
+
+        // 页尺寸收缩到实际使用的范围, 取 2 的幂以便重复寻址走掩码路径
+        int pageWidth = std::min(NextPowerOfTwo(usedWidth), m_PageSize);
+        int pageHeight = std::min(NextPowerOfTwo(usedHeight), m_PageSize);
+        int page = (int)m_Pages.size();
+        std::vector<std::vector<uint8_t>> pixels(m_LayerCount, std::vector<uint8_t>((size_t)pageWidth * pageHeight * 4, 0));
+
+        for (const stbrp_rect& rect : packed)
+        {
+            Entry& entry = m_Entries[rect.id];
+            entry.Region.Page = page;
+            entry.Region.Offset = { (float)(rect.x + m_Padding) / pageWidth, (float)(rect.y + m_Padding) / pageHeight };
+            entry.Region.Scale = { (float)entry.Width / pageWidth, (float)entry.Height / pageHeight };
+
+            // 复制纹素, 间隔区域用最近的边缘纹素填充
+            for (int layer = 0; layer < m_LayerCount; layer++)
+            {
+                const std::vector<uint8_t>& src = entry.Layers[layer];
+                std::vector<uint8_t>& dst = pixels[layer];
+                for (int y = 0; y < rect.h; y++)
+                {
+                    int sy = std::clamp(y - m_Padding, 0, entry.Height - 1);
+                    for (int x = 0; x < rect.w; x++)
+                    {
+                        int sx = std::clamp(x - m_Padding, 0, entry.Width - 1);
+                        memcpy(&dst[((size_t)(rect.y + y) * pageWidth + rect.x + x) * 4], &src[((size_t)sy * entry.Width + sx) * 4], 4);
+                    }
+                }
+            }
+            entry.Layers.clear();
+            entry.Layers.shrink_to_fit();
+        }
+
+        /* 按各层最多的通道数紧凑存储 */
+        std::vector<std::unique_ptr<Texture>> textures;
+        for (int layer = 0; layer < m_LayerCount; layer++)
+        {
+            int channels = m_Channels[layer];
+            std::vector<uint8_t>& data = pixels[layer];
+            if (channels < 4)
+            {
+                size_t texelCount = (size_t)pageWidth * pageHeight;
+                for (size_t i = 0; i < texelCount; i++)
+                    memmove(&data[i * channels], &data[i * 4], channels);
+            }
+            textures.push_back(std::make_unique<Texture>(pageWidth, pageHeight, (TextureFormat)((int)TextureFormat::R8 + channels - 1), data.data(), pageOptions));
+        }
+        m_Pages.push_back(std::move(textures));
+        pending = std::move(remaining);
+    }
+}
+
+void TextureAtlas::RemapTexCoords(std::vector<BlinnVertex>& vertices, const AtlasRegion& region)
+{
+    for (BlinnVertex& vertex : vertices)
+        vertex.TexCoord = RemapTexCoord(region, vertex.TexCoord);
+}
+
+}
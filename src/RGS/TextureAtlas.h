@@ -0,0 +1,81 @@
+#pragma once
+
+#include "RGS/Maths.h"
+#include "RGS/Texture.h"
+#include "RGS/Shaders/BlinnShader.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace RGS {
+
+// 图集中一张子纹理的位置, 图集纹理坐标 = Offset + 原纹理坐标 * Scale
+struct AtlasRegion
+{
+    int Page = 0;                       // 所在图集页
+    Vec2 Offset { 0.0f, 0.0f };
+    Vec2 Scale { 1.0f, 1.0f };
+};
+
+// 纹理图集: 将大量小纹理打包到少数几张大纹理中, 共用同一组纹理的物体可以合并为一次绘制
+// 每个条目可以有多层(如漫反射与镜面反射), 各层在图集中占据相同的区域, 因此共用一套纹理坐标
+class TextureAtlas
+{
+public:
+    /**
+     * @param layerCount 每个条目的纹理层数
+     * @param pageSize 图集页的边长
+     * @param padding 条目四周的间隔(纹素), 用边缘纹素填充, 避免过滤时采样到相邻条目
+     *                条目按不超过间隔的最大 2 的幂 2^k 对齐, 图集页只生成 k + 1 级 mipmap, 更粗糙的层级会混合相邻条目
+    */
+    TextureAtlas(const int layerCount = 1, const int pageSize = 2048, const int padding = 4);
+
+    /**
+     * @brief 添加一个条目, 其余层按第一层的尺寸缩放
+     * @param layerPaths 各层图片路径, 数量须与层数一致
+     * @return 条目编号, 加载失败返回 -1
+    */
+    int Add(const std::vector<std::string>& layerPaths);
+    /**
+     * @brief 打包所有条目并创建图集纹理, 之后不能再添加条目
+     * @param options 图集纹理的加载参数, mipmap 层数受间隔限制(见构造函数)
+    */
+    void Build(const TextureOptions& options = {});
+
+    int GetEntryCount() const { return (int)m_Entries.size(); }
+    int GetPageCount() const { return (int)m_Pages.size(); }
+    const AtlasRegion& GetRegion(const int entry) const { return m_Entries[entry].Region; }
+    const Texture* GetTexture(const int page, const int layer) const { return m_Pages[page][layer].get(); }
+
+    static Vec2 RemapTexCoord(const AtlasRegion& region, const Vec2 texCoord)
+    {
+        return { region.Offset.X + texCoord.X * region.Scale.X, region.Offset.Y + texCoord.Y * region.Scale.Y };
+    }
+    /**
+     * @brief 将顶点的纹理坐标映射到图集中的区域
+     *        原纹理坐标须在 [0, 1] 内, 图集不支持重复寻址
+    */
+    static void RemapTexCoords(std::vector<BlinnVertex>& vertices, const AtlasRegion& region);
+
+private:
+    struct Entry
+    {
+        int Width;
+        int Height;
+        std::vector<std::vector<uint8_t>> Layers;   // RGBA8, 打包后释放
+        AtlasRegion Region;
+    };
+
+private:
+    int m_LayerCount;
+    int m_PageSize;
+    int m_Padding;
+    int m_AlignShift;                                           // 条目按 1 << m_AlignShift 纹素对齐, 不超过间隔
+    std::vector<int> m_Channels;                                // 各层所有条目中最多的通道数, 决定图集纹理格式
+    std::vector<Entry> m_Entries;
+    std::vector<std::vector<std::unique_ptr<Texture>>> m_Pages; // [页][层]
+};
+
+}
@@ -0,0 +1,107 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace RGS {
+
+ThreadPool::ThreadPool(const int threadNum)
+{
+    int num = threadNum;
+    if (num <= 0)
+        num = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+    for (int i = 0; i < num; i++)
+    {
+        m_Workers.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Condition.notify_all();
+    for (std::thread& worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::Instance()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool& ThreadPool::Background()
+{
+    // 线程较少, 与帧内并行计算争用的核心有限
+    static ThreadPool pool(std::max(1, (int)std::thread::hardware_concurrency() / 4));
+    return pool;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]() { return m_Stop || !m_Tasks.empty(); });
+            if (m_Stop && m_Tasks.empty())
+                return;
+            task = std::move(m_Tasks.front());
+            m_Tasks.pop();
+        }
+        task();
+    }
+}
+
+bool ThreadPool::RunPendingTask()
+{
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Tasks.empty())
+            return false;
+        task = std::move(m_Tasks.front());
+        m_Tasks.pop();
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::ParallelFor(const int begin, const int end, const std::function<void(int, int)>& func, const int minBatch)
+{
+    const int count = end - begin;
+    if (count <= 0)
+        return;
+
+    // 调用线程也执行一个区间
+    int batchNum = std::min(GetThreadCount() + 1, (count + minBatch - 1) / std::max(1, minBatch));
+    if (batchNum <= 1)
+    {
+        func(begin, end);
+        return;
+    }
+
+    const int batchSize = (count + batchNum - 1) / batchNum;
+    std::vector<std::future<void>> futures;
+    futures.reserve(batchNum - 1);
+    for (int batchBegin = begin + batchSize; batchBegin < end; batchBegin += batchSize)
+    {
+        const int batchEnd = std::min(end, batchBegin + batchSize);
+        futures.push_back(Submit([&func, batchBegin, batchEnd]() { func(batchBegin, batchEnd); }));
+    }
+
+    func(begin, std::min(end, begin + batchSize));
+
+    for (std::future<void>& future : futures)
+    {
+        Wait(future);
+    }
+}
+
+}
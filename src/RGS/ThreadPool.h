@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace RGS {
+
+// 固定数量工作线程的线程池
+class ThreadPool
+{
+public:
+    /**
+     * @param threadNum 工作线程数, 0 表示使用硬件线程数 - 1 (调用线程也参与 ParallelFor)
+    */
+    explicit ThreadPool(const int threadNum = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int GetThreadCount() const { return (int)m_Workers.size(); }
+
+    /**
+     * @brief 提交任务, 返回可等待结果的 future
+    */
+    template<typename func_t>
+    auto Submit(func_t&& func) -> std::future<std::invoke_result_t<std::decay_t<func_t>>>
+    {
+        using result_t = std::invoke_result_t<std::decay_t<func_t>>;
+        auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<func_t>(func));
+        std::future<result_t> future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Tasks.emplace([task]() { (*task)(); });
+        }
+        m_Condition.notify_one();
+        return future;
+    }
+
+    /**
+     * @brief 将 [begin, end) 切分为若干连续区间并行执行 func(rangeBegin, rangeEnd), 返回时全部完成
+     * @param minBatch 每个区间的最小长度, 避免任务过碎
+    */
+    void ParallelFor(const int begin, const int end, const std::function<void(int, int)>& func, const int minBatch = 1);
+
+    /**
+     * @brief 等待 future 完成, 等待期间由调用线程执行队列中的任务(在工作线程中嵌套调用也不会死锁)
+    */
+    template<typename future_t>
+    void Wait(const future_t& future)
+    {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            if (!RunPendingTask())
+                future.wait_for(std::chrono::microseconds(100));
+        }
+    }
+
+    static ThreadPool& Instance();      // 帧内并行计算(ParallelFor 等)使用的线程池
+    /**
+     * @brief 后台线程池, 用于纹理解码、虚拟纹理页加载等耗时的异步资源加载
+     *        与 Instance() 分开排队, 渲染线程在 ParallelFor 中等待时不会执行这些任务
+    */
+    static ThreadPool& Background();
+
+private:
+    void WorkerLoop();
+    bool RunPendingTask();      // 执行一个队列中的任务, 队列为空时返回 false
+
+private:
+    std::vector<std::thread> m_Workers;
+    std::queue<std::function<void()>> m_Tasks;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_Stop = false;
+};
+
+}
@@ -0,0 +1,483 @@
+#include "Base.h"
+#include "Maths.h"
+#include "ThreadPool.h"
+#include "VirtualTexture.h"
+
+#include <stb_image/stb_image.h>
+#include <emmintrin.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace RGS {
+
+namespace {
+
+// .rgsvt 文件头, 之后依次为 LevelCount 个 VirtualLevelHeader 与页数据
+struct VirtualHeader
+{
+    char Magic[4];          // "RGSV"
+    uint32_t Version;
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t PageSize;      // 页大小(纹素, 不含边框)
+    uint32_t LevelCount;
+    uint32_t WrapU;         // 页边框按此寻址方式填充(WrapMode), 采样时使用同一方式
+    uint32_t WrapV;
+    uint64_t DataOffset;    // 页数据相对文件起始的偏移
+};
+
+struct VirtualLevelHeader
+{
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t PagesX;
+    uint32_t PagesY;
+};
+
+constexpr char VIRTUAL_MAGIC[4] = { 'R', 'G', 'S', 'V' };
+constexpr uint32_t VIRTUAL_VERSION = 2;
+constexpr int PAGE_BORDER = 1;      // 页边框宽度, 使双线性采样的 2x2 纹素总在同一页内
+
+inline __m128 LoadRGBA8(const uint8_t* texel)
+{
+    int packed;
+    memcpy(&packed, texel, sizeof(int));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i value = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+    return _mm_mul_ps(_mm_cvtepi32_ps(value), _mm_set1_ps(1.0f / 255.0f));
+}
+
+/**
+ * @brief 按寻址方式将纹理坐标映射到 [0, 1]
+*/
+inline float WrapCoord(const float t, const WrapMode mode)
+{
+    if (!std::isfinite(t))
+        return 0.0f;
+    switch (mode)
+    {
+    case WrapMode::REPEAT:
+        return t - std::floor(t);
+    case WrapMode::MIRROR:
+    {
+        float r = t - 2.0f * std::floor(t * 0.5f);
+        return r <= 1.0f ? r : 2.0f - r;
+    }
+    case WrapMode::CLAMP:
+    default:
+        return Clamp(t, 0.0f, 1.0f);
+    }
+}
+
+/**
+ * @brief 按寻址方式将纹素坐标映射到 [0, size), 与 Texture 的纹素寻址一致
+*/
+inline int WrapTexel(const int i, const int size, const WrapMode mode)
+{
+    switch (mode)
+    {
+    case WrapMode::REPEAT:
+    {
+        int r = i % size;
+        return r < 0 ? r + size : r;
+    }
+    case WrapMode::MIRROR:
+    {
+        int period = size * 2;
+        int r = i % period;
+        if (r < 0)
+            r += period;
+        return r < size ? r : period - 1 - r;
+    }
+    case WrapMode::CLAMP:
+    default:
+        return std::clamp(i, 0, size - 1);
+    }
+}
+
+}
+
+VirtualTexture::VirtualTexture(const std::string& path, const VirtualTextureOptions& options)
+    : m_Path(path), m_Options(options)
+{
+    m_File.open(path, std::ios::binary);
+    ASSERT(m_File);
+
+    VirtualHeader header;
+    m_File.read((char*)&header, sizeof(header));
+    ASSERT(m_File && memcmp(header.Magic, VIRTUAL_MAGIC, sizeof(VIRTUAL_MAGIC)) == 0 && header.Version == VIRTUAL_VERSION);
+    ASSERT(header.LevelCount > 0 && header.PageSize > 0);
+    ASSERT(header.WrapU <= (uint32_t)WrapMode::CLAMP && header.WrapV <= (uint32_t)WrapMode::CLAMP);
+
+    m_Width = (int)header.Width;
+    m_Height = (int)header.Height;
+    m_PageSize = (int)header.PageSize;
+    m_StoredPageSize = m_PageSize + PAGE_BORDER * 2;
+    m_PageBytes = (size_t)m_StoredPageSize * m_StoredPageSize * 4;
+    m_DataOffset = header.DataOffset;
+    m_WrapU = (WrapMode)header.WrapU;
+    m_WrapV = (WrapMode)header.WrapV;
+
+    int pageCount = 0;
+    int pinnedCount = 0;
+    for (uint32_t l = 0; l < header.LevelCount; l++)
+    {
+        VirtualLevelHeader levelHeader;
+        m_File.read((char*)&levelHeader, sizeof(levelHeader));
+        ASSERT(m_File);
+        Level level = { (int)levelHeader.Width, (int)levelHeader.Height, (int)levelHeader.PagesX, (int)levelHeader.PagesY,
+                        pageCount, (float)levelHeader.Width, (float)levelHeader.Height };
+        m_Levels.push_back(level);
+        pageCount += level.PagesX * level.PagesY;
+        if (level.PagesX * level.PagesY == 1)
+            pinnedCount++;
+    }
+
+    m_PageTable.assign(pageCount, -1);
+    m_Feedback = std::make_unique<std::atomic<uint8_t>[]>(pageCount);
+    for (int i = 0; i < pageCount; i++)
+        m_Feedback[i].store(0, std::memory_order_relaxed);
+
+    // 只有一页的粗糙层级常驻, 保证采样时总能找到可用的层级
+    int slotCount = std::max(m_Options.MaxResidentPages, 1) + pinnedCount;
+    m_Slots.resize(slotCount);
+    m_SlotData.resize((size_t)slotCount * m_PageBytes);
+    int slot = m_Options.MaxResidentPages;
+    for (const Level& level : m_Levels)
+    {
+        if (level.PagesX * level.PagesY != 1)
+            continue;
+        LoadPage(level.FirstPage, slot);
+        m_Slots[slot].Page = level.FirstPage;
+        m_Slots[slot].Pinned = true;
+        m_PageTable[level.FirstPage] = slot;
+        slot++;
+    }
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    // 加载任务会写入槽位数据, 析构前必须全部完成
+    for (std::future<void>& load : m_Loads)
+        load.wait();
+}
+
+int VirtualTexture::GetResidentPageCount() const
+{
+    int count = 0;
+    for (const Slot& slot : m_Slots)
+    {
+        if (slot.Page >= 0 && !slot.Loading)
+            count++;
+    }
+    return count;
+}
+
+Vec4 VirtualTexture::Sample(const Sampler& sampler, Vec2 texCoords, Vec2 ddx, Vec2 ddy) const
+{
+    if (sampler.Filter != TextureFilter::TRILINEAR)
+        return SampleResident(sampler, 0, texCoords);
+
+    /* 与 Texture 相同的层级选择 */
+    float dxU = ddx.X * m_Width, dxV = ddx.Y * m_Height;
+    float dyU = ddy.X * m_Width, dyV = ddy.Y * m_Height;
+    float lenSq = std::max(dxU * dxU + dxV * dxV, dyU * dyU + dyV * dyV);
+    float lod = sampler.LodBias;
+    if (lenSq > 1.0f && std::isfinite(lenSq))
+        lod += 0.5f * std::log2(lenSq);
+    return SampleLevel(sampler, texCoords, lod);
+}
+
+Vec4 VirtualTexture::SampleLevel(const Sampler& sampler, Vec2 texCoords, float lod) const
+{
+    float maxLevel = (float)(m_Levels.size() - 1);
+    lod = Clamp(lod, 0.0f, maxLevel);
+    int level0 = (int)lod;
+    float t = lod - (float)level0;
+    Vec4 color = SampleResident(sampler, level0, texCoords);
+    if (t > 0.0f)
+    {
+        color = Lerp(color, SampleResident(sampler, level0 + 1, texCoords), t);
+    }
+    return color;
+}
+
+Vec4 VirtualTexture::SampleResident(const Sampler& sampler, int level, Vec2 texCoords) const
+{
+    // 页边框按文件记录的寻址方式填充, 采样器的寻址方式不起作用
+    texCoords = { WrapCoord(texCoords.X, m_WrapU), WrapCoord(texCoords.Y, m_WrapV) };
+
+    // 记录需要的页, 页未驻留时逐级退回到更粗糙的层级
+    const Level& wanted = m_Levels[level];
+    m_Feedback[wanted.FirstPage + GetPageIndex(wanted, texCoords)].store(1, std::memory_order_relaxed);
+    Vec4 color;
+    for (; level < (int)m_Levels.size(); level++)
+    {
+        if (SampleBilinear(color, sampler, level, texCoords))
+            return color;
+    }
+    return { 0.0f, 0.0f, 0.0f, 0.0f };
+}
+
+int VirtualTexture::GetPageIndex(const Level& level, Vec2 texCoords) const
+{
+    int px = std::min((int)(texCoords.X * level.ScaleX) / m_PageSize, level.PagesX - 1);
+    int py = std::min((int)(texCoords.Y * level.ScaleY) / m_PageSize, level.PagesY - 1);
+    return py * level.PagesX + px;
+}
+
+bool VirtualTexture::SampleBilinear(Vec4& color, const Sampler& sampler, const int levelIndex, Vec2 texCoords) const
+{
+    const Level& level = m_Levels[levelIndex];
+    int page = GetPageIndex(level, texCoords);
+    int slot = m_PageTable[level.FirstPage + page];
+    if (slot < 0)
+        return false;
+
+    // 页内坐标, 边框保证 [-1, PageSize] 范围内的纹素都在页内
+    int pageX = page % level.PagesX;
+    int pageY = page / level.PagesX;
+    float fx = texCoords.X * level.ScaleX - 0.5f - (float)(pageX * m_PageSize);
+    float fy = texCoords.Y * level.ScaleY - 0.5f - (float)(pageY * m_PageSize);
+    if (sampler.Filter == TextureFilter::NEAREST)
+    {
+        fx += 0.5f;
+        fy += 0.5f;
+    }
+    float floorX = std::floor(fx);
+    float floorY = std::floor(fy);
+    int x0 = (int)Clamp(floorX, -1.0f, (float)m_PageSize) + PAGE_BORDER;
+    int y0 = (int)Clamp(floorY, -1.0f, (float)m_PageSize) + PAGE_BORDER;
+    const uint8_t* texels = m_SlotData.data() + (size_t)slot * m_PageBytes;
+    const uint8_t* row0 = texels + (size_t)y0 * m_StoredPageSize * 4;
+
+    __m128 result;
+    if (sampler.Filter == TextureFilter::NEAREST)
+    {
+        result = LoadRGBA8(row0 + x0 * 4);
+    }
+    else
+    {
+        int x1 = std::min(x0 + 1, m_StoredPageSize - 1);
+        int y1 = std::min(y0 + 1, m_StoredPageSize - 1);
+        const uint8_t* row1 = texels + (size_t)y1 * m_StoredPageSize * 4;
+        float tx = Clamp(fx - floorX, 0.0f, 1.0f);
+        float ty = Clamp(fy - floorY, 0.0f, 1.0f);
+        __m128 w00 = _mm_set1_ps((1.0f - tx) * (1.0f - ty));
+        __m128 w10 = _mm_set1_ps(tx * (1.0f - ty));
+        __m128 w01 = _mm_set1_ps((1.0f - tx) * ty);
+        __m128 w11 = _mm_set1_ps(tx * ty);
+        result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(LoadRGBA8(row0 + x0 * 4), w00), _mm_mul_ps(LoadRGBA8(row0 + x1 * 4), w10)),
+                            _mm_add_ps(_mm_mul_ps(LoadRGBA8(row1 + x0 * 4), w01), _mm_mul_ps(LoadRGBA8(row1 + x1 * 4), w11)));
+    }
+    _mm_storeu_ps(&color.X, result);
+    return true;
+}
+
+void VirtualTexture::Update()
+{
+    CommitLoadedPages();
+
+    /* 收集反馈: 已驻留的页更新使用时间, 缺失的页加入请求列表 */
+    std::vector<int> requests;
+    for (int page = 0; page < (int)m_PageTable.size(); page++)
+    {
+        if (!m_Feedback[page].exchange(0, std::memory_order_relaxed))
+            continue;
+        int slot = m_PageTable[page];
+        if (slot >= 0)
+            m_Slots[slot].LastUse = m_Frame;
+        else
+            requests.push_back(page);
+    }
+
+    // 粗糙层级的页编号更大, 优先加载, 使退回的层级尽快变清晰
+    std::sort(requests.begin(), requests.end(), [](const int a, const int b) { return a > b; });
+
+    int issued = 0;
+    for (int page : requests)
+    {
+        if (issued >= m_Options.MaxRequestsPerUpdate)
+            break;
+        bool loading = false;
+        for (const Slot& slot : m_Slots)
+        {
+            if (slot.Loading && slot.Page == page)
+            {
+                loading = true;
+                break;
+            }
+        }
+        if (loading)
+            continue;
+
+        // 淘汰最久未使用的槽位, 本帧使用过的页不淘汰
+        int victim = -1;
+        for (int i = 0; i < m_Options.MaxResidentPages; i++)
+        {
+            const Slot& slot = m_Slots[i];
+            if (slot.Loading || (slot.Page >= 0 && slot.LastUse >= m_Frame))
+                continue;
+            if (victim < 0 || slot.Page < 0 || slot.LastUse < m_Slots[victim].LastUse)
+            {
+                victim = i;
+                if (slot.Page < 0)
+                    break;
+            }
+        }
+        if (victim < 0)
+            break;
+
+        Slot& slot = m_Slots[victim];
+        if (slot.Page >= 0)
+            m_PageTable[slot.Page] = -1;
+        slot.Page = page;
+        slot.Loading = true;
+        slot.LastUse = m_Frame;
+        m_Loads.push_back(ThreadPool::Background().Submit([this, page, victim]()
+            {
+                LoadPage(page, victim);
+                std::lock_guard<std::mutex> lock(m_LoadMutex);
+                m_LoadedPages.emplace_back(page, victim);
+            }));
+        issued++;
+    }
+
+    // 丢弃已完成的任务
+    m_Loads.erase(std::remove_if(m_Loads.begin(), m_Loads.end(), [](const std::future<void>& load)
+        {
+            return load.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }), m_Loads.end());
+    m_Frame++;
+}
+
+void VirtualTexture::WaitForLoads()
+{
+    for (std::future<void>& load : m_Loads)
+        ThreadPool::Background().Wait(load);
+    m_Loads.clear();
+    CommitLoadedPages();
+}
+
+void VirtualTexture::CommitLoadedPages()
+{
+    // 页表只在此处(渲染之外)修改, 采样时无需加锁
+    std::lock_guard<std::mutex> lock(m_LoadMutex);
+    for (const auto& [page, slot] : m_LoadedPages)
+    {
+        m_Slots[slot].Loading = false;
+        m_PageTable[page] = slot;
+    }
+    m_LoadedPages.clear();
+}
+
+void VirtualTexture::LoadPage(const int page, const int slot)
+{
+    std::lock_guard<std::mutex> lock(m_FileMutex);
+    m_File.seekg((std::streamoff)(m_DataOffset + (uint64_t)page * m_PageBytes));
+    m_File.read((char*)m_SlotData.data() + (size_t)slot * m_PageBytes, (std::streamsize)m_PageBytes);
+    ASSERT(m_File);
+}
+
+bool VirtualTexture::Build(const std::string& imagePath, const std::string& outputPath, const int pageSize,
+                           const WrapMode wrapU, const WrapMode wrapV)
+{
+    ASSERT(pageSize > 0);
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load_thread(1);
+    stbi_uc* image = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);   // 统一为 RGBA8
+    if (!image)
+        return false;
+
+    // 与 Texture 一致: 灰度+透明度存为 (Y, A), 缺失的通道读作 0
+    if (channels < 4)
+    {
+        for (size_t i = 0; i < (size_t)width * height; i++)
+        {
+            if (channels == 2)
+                image[i * 4 + 1] = image[i * 4 + 3];    // stbi 展开为 (Y, Y, Y, A)
+            for (int c = channels; c < 4; c++)
+                image[i * 4 + c] = 0;
+        }
+    }
+
+    /* 生成 mipmap 链(2x2 盒式滤波) */
+    std::vector<std::vector<uint8_t>> levels;
+    std::vector<VirtualLevelHeader> levelHeaders;
+    levels.emplace_back(image, image + (size_t)width * height * 4);
+    stbi_image_free(image);
+    int levelWidth = width, levelHeight = height;
+    while (true)
+    {
+        levelHeaders.push_back({ (uint32_t)levelWidth, (uint32_t)levelHeight,
+                                 (uint32_t)((levelWidth + pageSize - 1) / pageSize), (uint32_t)((levelHeight + pageSize - 1) / pageSize) });
+        if (levelWidth == 1 && levelHeight == 1)
+            break;
+        int nextWidth = std::max(1, levelWidth / 2);
+        int nextHeight = std::max(1, levelHeight / 2);
+        const std::vector<uint8_t>& src = levels.back();
+        std::vector<uint8_t> dst((size_t)nextWidth * nextHeight * 4);
+        for (int y = 0; y < nextHeight; y++)
+        {
+            const uint8_t* row0 = src.data() + (size_t)std::min(y * 2, levelHeight - 1) * levelWidth * 4;
+            const uint8_t* row1 = src.data() + (size_t)std::min(y * 2 + 1, levelHeight - 1) * levelWidth * 4;
+            for (int x = 0; x < nextWidth; x++)
+            {
+                int x0 = std::min(x * 2, levelWidth - 1) * 4;
+                int x1 = std::min(x * 2 + 1, levelWidth - 1) * 4;
+                for (int c = 0; c < 4; c++)
+                    dst[((size_t)y * nextWidth + x) * 4 + c] = (uint8_t)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+        levels.push_back(std::move(dst));
+        levelWidth = nextWidth;
+        levelHeight = nextHeight;
+    }
+
+    std::ofstream file(outputPath, std::ios::binary);
+    if (!file)
+        return false;
+
+    VirtualHeader header = {};
+    memcpy(header.Magic, VIRTUAL_MAGIC, sizeof(VIRTUAL_MAGIC));
+    header.Version = VIRTUAL_VERSION;
+    header.Width = (uint32_t)width;
+    header.Height = (uint32_t)height;
+    header.PageSize = (uint32_t)pageSize;
+    header.LevelCount = (uint32_t)levels.size();
+    header.WrapU = (uint32_t)wrapU;
+    header.WrapV = (uint32_t)wrapV;
+    header.DataOffset = sizeof(VirtualHeader) + levels.size() * sizeof(VirtualLevelHeader);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)levelHeaders.data(), (std::streamsize)(levelHeaders.size() * sizeof(VirtualLevelHeader)));
+
+    /* 逐页写出, 每页四周带 1 纹素边框(取相邻页的纹素, 纹理边缘处按寻址方式取纹素) */
+    const int storedSize = pageSize + PAGE_BORDER * 2;
+    std::vector<uint8_t> page((size_t)storedSize * storedSize * 4);
+    for (size_t l = 0; l < levels.size(); l++)
+    {
+        const VirtualLevelHeader& level = levelHeaders[l];
+        const int w = (int)level.Width, h = (int)level.Height;
+        for (uint32_t py = 0; py < level.PagesY; py++)
+        {
+            for (uint32_t px = 0; px < level.PagesX; px++)
+            {
+                for (int y = 0; y < storedSize; y++)
+                {
+                    int sy = WrapTexel((int)py * pageSize + y - PAGE_BORDER, h, wrapV);
+                    for (int x = 0; x < storedSize; x++)
+                    {
+                        int sx = WrapTexel((int)px * pageSize + x - PAGE_BORDER, w, wrapU);
+                        memcpy(&page[((size_t)y * storedSize + x) * 4], &levels[l][((size_t)sy * w + sx) * 4], 4);
+                    }
+                }
+                file.write((const char*)page.data(), (std::streamsize)page.size());
+            }
+        }
+    }
+    return (bool)file;
+}
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "RGS/Maths.h"
+#include "RGS/Sampler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace RGS {
+
+struct VirtualTextureOptions
+{
+    int MaxResidentPages = 256;         // 页缓存容量(页数), 决定常驻内存上限
+    int MaxRequestsPerUpdate = 32;      // 每次 Update 最多发起的页加载数
+};
+
+// 虚拟纹理: 纹理按固定大小的页存放在磁盘上(.rgsvt), 只有被采样到的页才会异步加载到有限的页缓存中
+// 采样时记录用到的页(反馈), 缺失的页先用已驻留的更粗糙层级代替
+class VirtualTexture
+{
+public:
+    static constexpr int DEFAULT_PAGE_SIZE = 128;
+    static constexpr const char* EXTENSION = ".rgsvt";
+
+    VirtualTexture(const std::string& path, const VirtualTextureOptions& options = {});
+    ~VirtualTexture();
+
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    int GetLevelCount() const { return (int)m_Levels.size(); }
+    int GetPageSize() const { return m_PageSize; }
+    size_t GetMemorySize() const { return m_SlotData.size(); }     // 页缓存占用的字节数, 与纹理尺寸无关
+    int GetResidentPageCount() const;
+
+    WrapMode GetWrapU() const { return m_WrapU; }
+    WrapMode GetWrapV() const { return m_WrapV; }
+
+    /**
+     * @brief 三线性纹理采样, 同时记录用到的页; 页未驻留时使用更粗糙的已驻留层级
+     *        寻址方式由文件决定(见 Build), 忽略采样器中的寻址方式
+    */
+    Vec4 Sample(const Sampler& sampler, Vec2 texCoords, Vec2 ddx, Vec2 ddy) const;
+    Vec4 SampleLevel(const Sampler& sampler, Vec2 texCoords, float lod) const;
+
+    /**
+     * @brief 每帧渲染结束后调用: 提交已加载完成的页, 根据本帧反馈淘汰最久未使用的页并发起异步加载, 然后清空反馈
+    */
+    void Update();
+    void WaitForLoads();    // 等待所有进行中的页加载完成并提交
+
+    /**
+     * @brief 将图片切分为带 1 纹素边框的页并生成 mipmap, 写入 .rgsvt 文件
+     * @param pageSize 页大小(纹素, 不含边框)
+     * @param wrapU 纹理边缘处页边框的填充方式, 记录在文件中, 采样时使用同一寻址方式
+     * @param wrapV 同上, V 方向
+     * @return 是否写入成功
+    */
+    static bool Build(const std::string& imagePath, const std::string& outputPath, const int pageSize = DEFAULT_PAGE_SIZE,
+                      const WrapMode wrapU = WrapMode::REPEAT, const WrapMode wrapV = WrapMode::REPEAT);
+
+private:
+    struct Level
+    {
+        int Width;
+        int Height;
+        int PagesX;         // 横向页数
+        int PagesY;         // 纵向页数
+        int FirstPage;      // 该层级第一页的全局页编号
+        float ScaleX;       // 纹理坐标到纹素坐标的缩放
+        float ScaleY;
+    };
+
+    struct Slot
+    {
+        int Page = -1;              // 存放的全局页编号, -1 表示空
+        uint64_t LastUse = 0;       // 最近一次被采样的帧号
+        bool Pinned = false;        // 常驻(最粗糙的单页层级), 不会被淘汰
+        bool Loading = false;       // 正在加载, 加载完成并提交前不能被使用或淘汰
+    };
+
+    bool SampleBilinear(Vec4& color, const Sampler& sampler, const int level, Vec2 texCoords) const;     // 页未驻留时返回 false
+    Vec4 SampleResident(const Sampler& sampler, int level, Vec2 texCoords) const;      // 从 level 开始向粗糙层级查找已驻留的页
+    int GetPageIndex(const Level& level, Vec2 texCoords) const;
+    void LoadPage(const int page, const int slot);      // 从文件读取一页到槽位
+    void CommitLoadedPages();
+
+private:
+    std::string m_Path;
+    VirtualTextureOptions m_Options;
+    int m_Width = 0;
+    int m_Height = 0;
+    int m_PageSize = DEFAULT_PAGE_SIZE;
+    int m_StoredPageSize = DEFAULT_PAGE_SIZE + 2;   // 含边框的页边长
+    size_t m_PageBytes = 0;                         // 每页字节数(RGBA8)
+    uint64_t m_DataOffset = 0;                      // 页数据相对文件起始的偏移
+    WrapMode m_WrapU = WrapMode::REPEAT;            // 页边框的寻址方式, 来自文件
+    WrapMode m_WrapV = WrapMode::REPEAT;
+    std::vector<Level> m_Levels;
+
+    std::vector<int> m_PageTable;                       // 全局页编号 -> 槽位, -1 表示未驻留
+    std::unique_ptr<std::atomic<uint8_t>[]> m_Feedback; // 本帧被采样到的页
+    std::vector<Slot> m_Slots;
+    std::vector<uint8_t> m_SlotData;                    // 所有槽位的纹素数据
+    uint64_t m_Frame = 1;
+
+    std::ifstream m_File;
+    std::mutex m_FileMutex;
+    std::mutex m_LoadMutex;
+    std::vector<std::pair<int, int>> m_LoadedPages;     // 已加载完成待提交的 (页, 槽位)
+    std::vector<std::future<void>> m_Loads;             // 进行中的加载任务
+};
+
+}
@@ -14,6 +14,7 @@ namespace RGS {
         virtual void DrawFramebuffer(const Framebuffer& framebuffer) = 0;
 
         bool Closed() const { return m_Closed; }
+        void SetDither(const bool dither) { m_Dither = dither; }    // 显示时是否启用有序抖动
         char GetKey(const uint32_t index) const { return m_Keys[index]; }
 
     public:
@@ -28,6 +29,7 @@ namespace RGS {
         int m_Width;
         int m_Height;
         bool m_Closed = true;
+        bool m_Dither = false;
 
         char m_Keys[RGS_KEY_MAX_COUNT];
     };
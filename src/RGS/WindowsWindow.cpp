@@ -1,5 +1,6 @@
 #include "Base.h"
 
+#include "ColorConvert.h"
 #include "Window.h"
 #include "InputCodes.h"
 #include "WindowsWindow.h"
@@ -83,7 +84,7 @@ WindowsWindow::WindowsWindow(const std::string title, const int width, const int
     biHeader.biWidth = ((long)m_Width);             // 位图宽度
     biHeader.biHeight = -((long)m_Height);           // 位图高度
     biHeader.biPlanes = 1;                          // 颜色平面数
-    biHeader.biBitCount = 24;                       // 位深度
+    biHeader.biBitCount = 32;                       // 位深度, 每像素 4 字节(BGRA), 行无填充字节, 可按像素连续写入
     biHeader.biCompression = BI_RGB;                // 压缩类型
 
     // 分配空间
@@ -91,7 +92,7 @@ WindowsWindow::WindowsWindow(const std::string title, const int width, const int
     // CreateDIBSection函数创建一个DIB（设备独立位图）对象, 该对象可以直接访问其位图数据
     newBitmap = CreateDIBSection(m_MemoryDC, (BITMAPINFO*)&biHeader, DIB_RGB_COLORS, (void**)&m_Buffer, nullptr, 0);
     ASSERT(newBitmap != nullptr);
-    constexpr int channelCount = 3;     // 通道数, constexpr: 编译时常量
+    constexpr int channelCount = 4;     // 通道数, constexpr: 编译时常量
     int size = m_Width * m_Height * channelCount * sizeof(unsigned char);   // 位图大小
     memset(m_Buffer, 0, size);
     oldBitmap = (HBITMAP)SelectObject(m_MemoryDC, newBitmap);       // 选择新位图
@@ -186,26 +187,9 @@ void WindowsWindow::DrawFramebuffer(const Framebuffer& framebuffer)
     const int fHeight = framebuffer.GetHeight();
     const int width = m_Width < fWidth ? m_Width : fWidth;
     const int height = m_Height < fHeight ? m_Height : fHeight;
-    for (int i = 0; i < height; i++)
-    {
-        for (int j = 0; j < width; j++)
-        {
-            // 翻转RGB显示
-            constexpr int channelCount = 3;
-            constexpr int rChannel = 2;
-            constexpr int gChannel = 1;
-            constexpr int bChannel = 0;
-
-            Vec3 color = framebuffer.GetColor(j, fHeight - 1 - i);
-            const int pixStart = (i * m_Width + j) * channelCount;
-            const int rIndex = pixStart + rChannel;
-            const int gIndex = pixStart + gChannel;
-            const int bIndex = pixStart + bChannel;
-
-            m_Buffer[rIndex] = Float2UChar(color.X);
-            m_Buffer[gIndex] = Float2UChar(color.Y);
-            m_Buffer[bIndex] = Float2UChar(color.Z);
-        }
-    }
+
+    // 按行带并行转换为 BGRA8 并垂直翻转
+    constexpr int channelCount = 4;
+    ConvertFramebufferToBGRA8(m_Buffer, m_Width * channelCount, framebuffer, width, height, m_Dither);
     Show();
 }
@@ -0,0 +1,2 @@
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <stb_image/stb_rect_pack.h>
\ No newline at end of file
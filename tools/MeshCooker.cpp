@@ -0,0 +1,85 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "RGS/Mesh.h"
+
+namespace {
+
+void PrintStats(const char* name, const RGS::VertexCacheStats& stats)
+{
+    std::cout << "  " << name << ": ACMR " << stats.ACMR << ", ATVR " << stats.ATVR << std::endl;
+}
+
+}
+
+// 离线网格预处理工具: 解析 OBJ、去重、优化、生成细节层级并划分网格簇, 写入可直接映射使用的 .rgsmesh 文件
+// 用法: MeshCooker <输入.obj> [输出.rgsmesh] [--no-optimize] [--no-lods] [--no-meshlets]     未指定输出时写入 <输入.obj>.rgsmesh(即运行时使用的缓存)
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: MeshCooker <input.obj> [output.rgsmesh] [--no-optimize] [--no-lods] [--no-meshlets]" << std::endl;
+        return 1;
+    }
+
+    std::string inputPath = argv[1];
+    std::string outputPath = inputPath + RGS::Mesh::COOKED_EXTENSION;
+    bool optimize = true;
+    bool generateLods = true;
+    bool buildMeshlets = true;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--no-optimize")
+            optimize = false;
+        else if (arg == "--no-lods")
+            generateLods = false;
+        else if (arg == "--no-meshlets")
+            buildMeshlets = false;
+        else if (arg.rfind("--", 0) == 0)
+        {
+            std::cout << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+        else
+            outputPath = arg;
+    }
+
+    RGS::MeshOptions options;
+    options.UseCache = false;
+    RGS::Mesh mesh(inputPath, options);
+    if (optimize)
+    {
+        RGS::MeshOptimizeStats stats = mesh.Optimize();
+        std::cout << "Vertex cache (" << RGS::DEFAULT_VERTEX_CACHE_SIZE << " entries):" << std::endl;
+        PrintStats("before", stats.Before);
+        PrintStats("after ", stats.After);
+    }
+    if (generateLods)
+    {
+        mesh.GenerateLods();
+        const std::vector<RGS::MeshLod>& lods = mesh.GetLods();
+        for (size_t i = 0; i < lods.size(); i++)
+        {
+            std::cout << "  LOD " << i << ": " << lods[i].IndexCount / 3 << " triangles, " << lods[i].VertexCount
+                << " vertices, error " << lods[i].Error << std::endl;
+        }
+    }
+    if (buildMeshlets)
+    {
+        mesh.BuildMeshlets();
+        std::cout << "Meshlets: " << mesh.GetMeshletCount() << " (max " << RGS::MAX_MESHLET_VERTICES << " vertices, "
+            << RGS::MAX_MESHLET_TRIANGLES << " triangles)" << std::endl;
+    }
+
+    if (!mesh.SaveCooked(outputPath, inputPath))
+    {
+        std::cout << "Failed to write " << outputPath << std::endl;
+        return 1;
+    }
+
+    std::cout << inputPath << " -> " << outputPath << ": " << mesh.GetVertexCount() << " vertices, "
+        << mesh.GetTriangleCount() << " triangles, " << mesh.GetMemorySize() << " bytes" << std::endl;
+    return 0;
+}
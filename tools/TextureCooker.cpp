@@ -0,0 +1,71 @@
+#include <iostream>
+#include <string>
+
+#include "RGS/Texture.h"
+#include "RGS/VirtualTexture.h"
+
+// 离线纹理预处理工具: 解码图片, 转换格式、分块并生成 mipmap, 写入可直接映射使用的 .rgstex 文件
+// 用法: TextureCooker <输入图片> <输出.rgstex> [--linear] [--no-mips] [--float] [--bc]
+//       TextureCooker <输入图片> <输出.rgsvt> --virtual [页大小] [--clamp|--mirror]     生成按页存放的虚拟纹理, 默认重复寻址
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: TextureCooker <input> <output.rgstex> [--linear] [--no-mips] [--float] [--bc]" << std::endl;
+        std::cout << "       TextureCooker <input> <output.rgsvt> --virtual [pageSize] [--clamp|--mirror]" << std::endl;
+        return 1;
+    }
+
+    if (argc >= 4 && std::string(argv[3]) == "--virtual")
+    {
+        int pageSize = RGS::VirtualTexture::DEFAULT_PAGE_SIZE;
+        RGS::WrapMode wrap = RGS::WrapMode::REPEAT;
+        for (int i = 4; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--clamp")
+                wrap = RGS::WrapMode::CLAMP;
+            else if (arg == "--mirror")
+                wrap = RGS::WrapMode::MIRROR;
+            else
+                pageSize = std::stoi(arg);
+        }
+        if (pageSize <= 0 || !RGS::VirtualTexture::Build(argv[1], argv[2], pageSize, wrap, wrap))
+        {
+            std::cout << "Failed to write " << argv[2] << std::endl;
+            return 1;
+        }
+        std::cout << argv[1] << " -> " << argv[2] << ": virtual texture, " << pageSize << "x" << pageSize << " pages" << std::endl;
+        return 0;
+    }
+
+    RGS::TextureOptions options;
+    for (int i = 3; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--linear")
+            options.Layout = RGS::TextureLayout::LINEAR;
+        else if (arg == "--no-mips")
+            options.GenerateMipmaps = false;
+        else if (arg == "--float")
+            options.FloatStorage = true;
+        else if (arg == "--bc")
+            options.Compress = true;
+        else
+        {
+            std::cout << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    RGS::Texture texture(argv[1], options);
+    if (!texture.SaveCooked(argv[2]))
+    {
+        std::cout << "Failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << argv[1] << " -> " << argv[2] << ": " << texture.GetWidth() << "x" << texture.GetHeight()
+        << ", " << texture.GetLevelCount() << " levels, " << texture.GetMemorySize() << " bytes" << std::endl;
+    return 0;
+}